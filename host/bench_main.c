@@ -0,0 +1,7 @@
+#include "bench.h"
+
+// Host entry point for the kernel benchmark (bench.c is shared with the MicroBlaze build)
+int main(void) {
+	bench_run();
+	return 0;
+}
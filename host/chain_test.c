@@ -0,0 +1,507 @@
+#include "audio_chain.h"
+#include "delay.h"
+#include "tremolo.h"
+#include "chorus.h"
+#include "block_engine.h"
+#include "param_smooth.h"
+#include "looper.h"
+#include "lfo.h"
+#include "host_io.h"
+#include "pcm_io.h"
+#include "xil_io.h"
+#include "xparameters.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// HOST GOLDEN-VECTOR TEST OF THE AUDIO CHAIN
+// ============================================================================
+// Feeds 16-bit PCM through the same audio chain sampling_ISR() runs on the board
+// (via the simulated stream grabber in host_io.c) and compares the signed output
+// sample by sample against the stored golden vectors.
+//
+//   chain_test [--vectors DIR] [--update]     run every scenario (--update rewrites the goldens)
+//   chain_test --run SCENARIO IN OUT          process any WAV/raw file with a scenario's settings
+//   chain_test --make-input OUT               synthesize the test input
+//   chain_test --list                         list the scenarios
+
+// PCM -> raw mic value: the grabber delivers a large DC offset plus the signal
+// Full scale lands the conditioned signal around the +/-400 limiter thresholds.
+// The filters multiply (input - state) by up to 256, which only stays inside 32 bits
+// because the loud part of the test input is below 500 Hz (checked with -ftrapv)
+#define MIC_DC_BIAS      0x04000000
+#define MIC_SAMPLE_SHIFT 11
+
+// The input smoothing changes every output sample, so an INPUT_AVERAGE_LENGTH other
+// than the default needs its own set of goldens (golden_<name>_avg<length>.raw)
+#define STRINGIFY(x) #x
+#define TO_STRING(x) STRINGIFY(x)
+#if INPUT_AVERAGE_LENGTH == 4
+#define GOLDEN_SUFFIX ""
+#else
+#define GOLDEN_SUFFIX "_avg" TO_STRING(INPUT_AVERAGE_LENGTH)
+#endif
+
+#define TEST_INPUT_SAMPLES 16384 // ~0.34 s; long enough for the default 8000-sample delay to come back
+
+// ============================================================================
+// SCENARIOS
+// ============================================================================
+typedef enum {
+	RUN_SAMPLES = 0,        // audio_process_sample(), one sample at a time
+	RUN_BLOCKS,             // audio_process_block() in BLOCK_SIZE chunks
+	RUN_FRAMES,             // audio_process_frame(): AUDIO_CHANNELS interleaved output samples per input sample
+} run_mode_t;
+
+typedef struct {
+	const char* name;
+	const char* golden;     // golden vector name (block-mode scenarios reuse the per-sample golden)
+	run_mode_t run;
+	void (*setup)(void);    // effect enables and parameters, applied after a full reset
+	void (*change)(void);   // parameter change at TEST_CHANGE_SAMPLE, like an encoder turn (NULL = none)
+} scenario_t;
+
+#define TEST_CHANGE_SAMPLE 8192 // a multiple of every BLOCK_SIZE, so block mode sees it at the same sample
+
+static void setup_dry(void) {
+}
+
+static void setup_delay(void) {
+	delay_enabled = 1;
+}
+
+static void setup_delay_short(void) {
+	delay_enabled = 1;
+	delay_samples = DELAY_SAMPLES_MIN;
+}
+
+static void setup_delay_feedback(void) {
+	// short enough for several repeats to build up within the test input
+	delay_enabled = 1;
+	delay_samples = 3000;
+	delay_feedback = 160;
+}
+
+static void setup_delay_pattern(void) {
+	delay_enabled = 1;
+	delay_samples = 6000;
+	delay_feedback = 96;
+	delay_pattern = DELAY_PATTERN_TRIPLET;
+}
+
+static void setup_delay_reverse(void) {
+	// several chunk boundaries (and their crossfades) within the test input
+	delay_enabled = 1;
+	delay_samples = 2000;
+	delay_feedback = 96;
+	delay_reverse = 1;
+}
+
+static void setup_delay_duck(void) {
+	// the plucks duck the echoes, which come back up between them
+	delay_enabled = 1;
+	delay_samples = 3000;
+	delay_feedback = 128;
+	delay_duck = DELAY_DUCK_MAX;
+}
+
+static void setup_delay_tape(void) {
+	delay_enabled = 1;
+	delay_samples = 2500;
+	delay_feedback = 192;
+	delay_tape = 1;
+}
+
+static void setup_tremolo(void) {
+	tremolo_enabled = 1;
+}
+
+static void setup_tremolo_triangle(void) {
+	tremolo_enabled = 1;
+	tremolo_rate = TREMOLO_RATE_MAX;
+	tremolo_waveform = LFO_TRIANGLE;
+	update_tremolo_phase_inc();
+	update_tremolo_waveform();
+}
+
+static void setup_chorus(void) {
+	chorus_enabled = 1;
+}
+
+// Three voices spread evenly over the LFO cycle
+static void setup_chorus_voices(void) {
+	chorus_enabled = 1;
+	chorus_voices = 3;
+	update_chorus_spread();
+}
+
+// Short sweep with strong negative feedback (notches)
+static void setup_flanger(void) {
+	chorus_enabled = 1;
+	set_chorus_style(CHORUS_STYLE_FLANGER);
+	flanger_feedback = -192;
+}
+
+// Fast, deep vibrato: wet only, so the output is the pitch-modulated input
+static void setup_vibrato(void) {
+	chorus_enabled = 1;
+	chorus_rate = CHORUS_RATE_MAX;
+	update_chorus_phase_inc();
+	set_chorus_style(CHORUS_STYLE_VIBRATO);
+	vibrato_depth = 96;
+}
+
+static void setup_all(void) {
+	delay_enabled = 1;
+	tremolo_enabled = 1;
+	chorus_enabled = 1;
+}
+
+static void setup_filters(void) {
+	hp_filter_coeff = 40;
+	lp_filter_coeff = 160;
+}
+
+// Every smoothed parameter steps at once, by the encoder step sizes
+static void setup_changes(void) {
+	delay_enabled = 1;
+	tremolo_enabled = 1;
+	chorus_enabled = 1;
+	tremolo_depth = 128;
+}
+
+static void change_all(void) {
+	delay_samples -= DELAY_ADJUST_STEP;
+	chorus_delay += CHORUS_DELAY_ADJUST_STEP;
+	chorus_depth += 5 * CHORUS_DEPTH_ADJUST_STEP;
+	tremolo_depth = TREMOLO_DEPTH_MAX;
+	lp_filter_coeff += 20 * FILTER_COEFF_ADJUST_STEP;
+	hp_filter_coeff += 10 * FILTER_COEFF_ADJUST_STEP;
+}
+
+// Record from the start, close the loop at TEST_CHANGE_SAMPLE and play it under the input
+static void setup_looper(void) {
+	tremolo_enabled = 1;
+	// stamped a double-press window before the change, so the two presses are two single presses
+	looper_press(TEST_CHANGE_SAMPLE - LOOPER_DOUBLE_PRESS);
+}
+
+static void change_looper(void) {
+	looper_press(TEST_CHANGE_SAMPLE);
+}
+
+#if AUDIO_CHANNELS > 1
+// Repeats alternate between the channels
+static void setup_delay_pingpong(void) {
+	delay_enabled = 1;
+	delay_samples = 3000;
+	delay_feedback = 160;
+}
+
+// A delay time step mid-run: the ping-pong line crosses over from the old frame
+static void change_delay_pingpong(void) {
+	delay_samples -= DELAY_ADJUST_STEP;
+}
+#endif
+
+static const scenario_t scenarios[] = {
+	{ "dry",                   "dry",             RUN_SAMPLES, setup_dry,             NULL },
+	{ "delay",                 "delay",           RUN_SAMPLES, setup_delay,           NULL },
+	{ "delay_short",           "delay_short",     RUN_SAMPLES, setup_delay_short,     NULL },
+	{ "delay_feedback",        "delay_feedback",  RUN_SAMPLES, setup_delay_feedback,  NULL },
+	{ "delay_pattern",         "delay_pattern",   RUN_SAMPLES, setup_delay_pattern,   NULL },
+	{ "delay_reverse",         "delay_reverse",   RUN_SAMPLES, setup_delay_reverse,   NULL },
+	{ "delay_duck",            "delay_duck",      RUN_SAMPLES, setup_delay_duck,      NULL },
+	{ "delay_tape",            "delay_tape",      RUN_SAMPLES, setup_delay_tape,      NULL },
+	{ "tremolo",               "tremolo",         RUN_SAMPLES, setup_tremolo,         NULL },
+	{ "tremolo_triangle",      "tremolo_triangle", RUN_SAMPLES, setup_tremolo_triangle, NULL },
+	{ "chorus",                "chorus",          RUN_SAMPLES, setup_chorus,          NULL },
+	{ "chorus_voices",         "chorus_voices",   RUN_SAMPLES, setup_chorus_voices,   NULL },
+	{ "flanger",               "flanger",         RUN_SAMPLES, setup_flanger,         NULL },
+	{ "vibrato",               "vibrato",         RUN_SAMPLES, setup_vibrato,         NULL },
+	{ "all",                   "all",             RUN_SAMPLES, setup_all,             NULL },
+	{ "filters",               "filters",         RUN_SAMPLES, setup_filters,         NULL },
+	{ "changes",               "changes",         RUN_SAMPLES, setup_changes,         change_all },
+	{ "looper",                "looper",          RUN_SAMPLES, setup_looper,          change_looper },
+	{ "delay_short_block",     "delay_short",     RUN_BLOCKS,  setup_delay_short,     NULL },
+	{ "delay_feedback_block",  "delay_feedback",  RUN_BLOCKS,  setup_delay_feedback,  NULL },
+	{ "delay_pattern_block",   "delay_pattern",   RUN_BLOCKS,  setup_delay_pattern,   NULL },
+	{ "delay_reverse_block",   "delay_reverse",   RUN_BLOCKS,  setup_delay_reverse,   NULL },
+	{ "delay_duck_block",      "delay_duck",      RUN_BLOCKS,  setup_delay_duck,      NULL },
+	{ "delay_tape_block",      "delay_tape",      RUN_BLOCKS,  setup_delay_tape,      NULL },
+	{ "chorus_voices_block",   "chorus_voices",   RUN_BLOCKS,  setup_chorus_voices,   NULL },
+	{ "flanger_block",         "flanger",         RUN_BLOCKS,  setup_flanger,         NULL },
+	{ "vibrato_block",         "vibrato",         RUN_BLOCKS,  setup_vibrato,         NULL },
+	{ "all_block",             "all",             RUN_BLOCKS,  setup_all,             NULL },
+	{ "looper_block",          "looper",          RUN_BLOCKS,  setup_looper,          change_looper },
+#if AUDIO_CHANNELS > 1
+	{ "delay_pingpong",        "delay_pingpong",  RUN_FRAMES,  setup_delay_pingpong,  NULL },
+	{ "delay_pingpong_change", "delay_pingpong_change", RUN_FRAMES, setup_delay_pingpong, change_delay_pingpong },
+#endif
+#if BLOCK_SIZE == PARAM_SMOOTH_INTERVAL
+	// the ramps tick once per block, so they only line up with per-sample mode at this block size
+	{ "changes_block",         "changes",         RUN_BLOCKS,  setup_changes,         change_all },
+#endif
+};
+
+#define SCENARIO_COUNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static const scenario_t* find_scenario(const char* name) {
+	for (u32 i = 0; i < SCENARIO_COUNT; i++) {
+		if (strcmp(scenarios[i].name, name) == 0) return &scenarios[i];
+	}
+	return NULL;
+}
+
+// ============================================================================
+// CHAIN RUNNER
+// ============================================================================
+// The same register accesses as sampling_ISR(): select, read, process, restart grabber
+static int32_t fetch_sample(void) {
+	Xil_Out32(XPAR_MIC_BLOCK_STREAM_GRABBER_0_BASEADDR + 4, 0);
+	return (int32_t) Xil_In32(XPAR_MIC_BLOCK_STREAM_GRABBER_0_BASEADDR + 8);
+}
+
+static void next_sample(void) {
+	Xil_Out32(XPAR_MIC_BLOCK_STREAM_GRABBER_0_BASEADDR, 0);
+}
+
+// Returns: number of output samples (count, or count * AUDIO_CHANNELS interleaved for RUN_FRAMES)
+static u32 run_scenario(const scenario_t* scenario, const int16_t* input, int16_t* output, u32 count) {
+	int32_t* raw = malloc(count * sizeof(int32_t));
+	for (u32 i = 0; i < count; i++) {
+		raw[i] = MIC_DC_BIAS + ((int32_t) input[i] << MIC_SAMPLE_SHIFT);
+	}
+
+	init_audio_chain();
+	init_delay();
+	init_tremolo();
+	init_chorus();
+	scenario->setup();
+	host_grabber_load(raw, count);
+	u32 produced = count;
+
+	if (scenario->run == RUN_SAMPLES) {
+		for (u32 i = 0; i < count; i++) {
+			if (i == TEST_CHANGE_SAMPLE && scenario->change) scenario->change();
+			output[i] = (int16_t) audio_process_sample(fetch_sample());
+			next_sample();
+			looper_service(); // an idle main loop between every two samples
+		}
+	}
+#if AUDIO_CHANNELS > 1
+	else if (scenario->run == RUN_FRAMES) {
+		int32_t frame[AUDIO_CHANNELS];
+		for (u32 i = 0; i < count; i++) {
+			if (i == TEST_CHANGE_SAMPLE && scenario->change) scenario->change();
+			audio_process_frame(fetch_sample(), frame);
+			next_sample();
+			looper_service();
+			for (u32 ch = 0; ch < AUDIO_CHANNELS; ch++) {
+				output[i * AUDIO_CHANNELS + ch] = (int16_t) frame[ch];
+			}
+		}
+		produced = count * AUDIO_CHANNELS;
+	}
+#endif
+	else {
+		// no rings here: the block is processed as soon as it is complete, so the output
+		// lines up with per-sample mode instead of trailing it by block_engine_latency_samples()
+		int32_t block[BLOCK_SIZE];
+		for (u32 start = 0; start < count; start += BLOCK_SIZE) {
+			u32 length = (count - start < BLOCK_SIZE) ? count - start : BLOCK_SIZE;
+			if (start == TEST_CHANGE_SAMPLE && scenario->change) scenario->change();
+			for (u32 i = 0; i < length; i++) {
+				block[i] = fetch_sample();
+				next_sample();
+			}
+			audio_process_block(block, length);
+			looper_service();
+			for (u32 i = 0; i < length; i++) {
+				output[start + i] = (int16_t) block[i];
+			}
+		}
+	}
+
+	free(raw);
+	return produced;
+}
+
+// ============================================================================
+// GOLDEN VECTORS
+// ============================================================================
+static void golden_path(char* path, size_t size, const char* dir, const char* golden) {
+	snprintf(path, size, "%s/golden_%s%s.raw", dir, golden, GOLDEN_SUFFIX);
+}
+
+// Returns: number of mismatching samples (or count + 1 if the golden can't be read)
+static u32 compare_golden(const char* path, const int16_t* output, u32 count) {
+	int16_t* golden;
+	u32 golden_count;
+	if (pcm_read(path, &golden, &golden_count) != 0) {
+		return count + 1;
+	}
+
+	u32 mismatches = 0;
+	if (golden_count != count) {
+		printf("    length %u, golden has %u\n", count, golden_count);
+		mismatches = count + 1;
+	}
+	else {
+		for (u32 i = 0; i < count; i++) {
+			if (output[i] != golden[i]) {
+				if (mismatches < 5) {
+					printf("    sample %u: got %d, expected %d\n", i, output[i], golden[i]);
+				}
+				mismatches++;
+			}
+		}
+	}
+
+	free(golden);
+	return mismatches;
+}
+
+static int run_all(const char* dir, int update) {
+	char path[512];
+	snprintf(path, sizeof(path), "%s/input.wav", dir);
+
+	int16_t* input;
+	u32 count;
+	if (pcm_read(path, &input, &count) != 0) {
+		return 1;
+	}
+	int16_t* output = malloc(count * AUDIO_CHANNELS * sizeof(int16_t));
+
+	printf("chain_test: %u input samples, INPUT_AVERAGE_LENGTH=%d DELAY_LINE_POW2=%d DELAY_LINE_FORMAT=%d BLOCK_SIZE=%d CHORUS_INTERPOLATION=%d AUDIO_CHANNELS=%d\n",
+		   count, INPUT_AVERAGE_LENGTH, DELAY_LINE_POW2, DELAY_LINE_FORMAT, BLOCK_SIZE, CHORUS_INTERPOLATION, AUDIO_CHANNELS);
+
+	u32 failures = 0;
+	for (u32 s = 0; s < SCENARIO_COUNT; s++) {
+		const scenario_t* scenario = &scenarios[s];
+		u32 produced = run_scenario(scenario, input, output, count);
+		golden_path(path, sizeof(path), dir, scenario->golden);
+
+		if (update) {
+			// block-mode scenarios check against the per-sample golden; never let them write it
+			if (scenario->run == RUN_BLOCKS) continue;
+			if (pcm_write(path, output, produced, BLOCK_SAMPLE_RATE) != 0) return 1;
+			printf("  %-22s wrote %s\n", scenario->name, path);
+			continue;
+		}
+
+		u32 mismatches = compare_golden(path, output, produced);
+		if (mismatches == 0) {
+			printf("  %-22s ok\n", scenario->name);
+		}
+		else {
+			printf("  %-22s FAIL (%u mismatching samples)\n", scenario->name, mismatches);
+			failures++;
+		}
+	}
+
+	free(input);
+	free(output);
+
+	if (failures) {
+		printf("chain_test: %u of %u scenarios failed\n", failures, (u32) SCENARIO_COUNT);
+		return 1;
+	}
+	return 0;
+}
+
+// ============================================================================
+// TEST INPUT
+// ============================================================================
+// Fade-in from silence (the chain takes its DC bias from the first sample), a low
+// sustained tone, plucked notes every 4096 samples and a little noise
+static int make_input(const char* path) {
+	int16_t* samples = malloc(TEST_INPUT_SAMPLES * sizeof(int16_t));
+	u32 noise = 1;
+	const double two_pi = 6.283185307179586;
+
+	for (u32 i = 0; i < TEST_INPUT_SAMPLES; i++) {
+		double t = (double) i / BLOCK_SAMPLE_RATE;
+		double fade = (i < 2048) ? (double) i / 2048 : 1.0;
+		double value = 0.45 * sin(two_pi * 110 * t) + 0.1 * sin(two_pi * 330 * t);
+
+		u32 since_pluck = i % 4096;
+		if (i >= 1024 && since_pluck < 3072) {
+			value += 0.35 * sin(two_pi * 440 * since_pluck / BLOCK_SAMPLE_RATE) * exp(-(double) since_pluck / 700);
+		}
+
+		noise = noise * 1664525u + 1013904223u;
+		value += 0.01 * ((double) (noise >> 16) / 32768.0 - 1.0);
+
+		samples[i] = (int16_t) lrint(value * fade * 32767);
+	}
+
+	int result = pcm_write(path, samples, TEST_INPUT_SAMPLES, BLOCK_SAMPLE_RATE);
+	free(samples);
+	return result != 0;
+}
+
+// ============================================================================
+// SINGLE FILE
+// ============================================================================
+static int run_file(const char* name, const char* in_path, const char* out_path) {
+	const scenario_t* scenario = find_scenario(name);
+	if (!scenario) {
+		fprintf(stderr, "unknown scenario '%s' (see --list)\n", name);
+		return 1;
+	}
+
+	int16_t* input;
+	u32 count;
+	if (pcm_read(in_path, &input, &count) != 0) {
+		return 1;
+	}
+	int16_t* output = malloc(count * AUDIO_CHANNELS * sizeof(int16_t));
+
+	u32 produced = run_scenario(scenario, input, output, count);
+	int result = pcm_write(out_path, output, produced, BLOCK_SAMPLE_RATE);
+
+	free(input);
+	free(output);
+	return result != 0;
+}
+
+static void usage(void) {
+	fprintf(stderr,
+			"usage: chain_test [--vectors DIR] [--update]\n"
+			"       chain_test --run SCENARIO IN OUT\n"
+			"       chain_test --make-input OUT\n"
+			"       chain_test --list\n");
+}
+
+int main(int argc, char** argv) {
+	const char* dir = "vectors";
+	int update = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--vectors") == 0 && i + 1 < argc) {
+			dir = argv[++i];
+		}
+		else if (strcmp(argv[i], "--update") == 0) {
+			update = 1;
+		}
+		else if (strcmp(argv[i], "--run") == 0 && i + 3 < argc) {
+			return run_file(argv[i + 1], argv[i + 2], argv[i + 3]);
+		}
+		else if (strcmp(argv[i], "--make-input") == 0 && i + 1 < argc) {
+			return make_input(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "--list") == 0) {
+			for (u32 s = 0; s < SCENARIO_COUNT; s++) printf("%s\n", scenarios[s].name);
+			return 0;
+		}
+		else {
+			usage();
+			return 2;
+		}
+	}
+
+	return run_all(dir, update);
+}
@@ -0,0 +1,68 @@
+#include "host_io.h"
+#include "xil_io.h"
+#include "xil_printf.h"
+#include "xparameters.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+// ============================================================================
+// SIMULATED STREAM GRABBER
+// ============================================================================
+static const int32_t* grabber_samples = 0;
+static u32 grabber_count = 0;
+static u32 grabber_position = 0;
+
+void host_grabber_load(const int32_t* samples, u32 count) {
+	grabber_samples = samples;
+	grabber_count = count;
+	grabber_position = 0;
+}
+
+u32 host_grabber_position(void) {
+	return grabber_position;
+}
+
+u32 Xil_In32(UINTPTR addr) {
+	if (addr == XPAR_MIC_BLOCK_STREAM_GRABBER_0_BASEADDR + 8 && grabber_count > 0) {
+		u32 index = (grabber_position < grabber_count) ? grabber_position : grabber_count - 1;
+		return (u32) grabber_samples[index];
+	}
+	return 0;
+}
+
+void Xil_Out32(UINTPTR addr, u32 value) {
+	(void) value;
+	if (addr == XPAR_MIC_BLOCK_STREAM_GRABBER_0_BASEADDR) {
+		grabber_position++;
+	}
+}
+
+// ============================================================================
+// XIL_PRINTF
+// ============================================================================
+// The firmware passes u32 arguments with %lu/%ld/%lx (u32 is 32 bits on MicroBlaze,
+// like long). On a 64-bit host long is wider, so drop the 'l' before printing.
+void xil_printf(const char* format, ...) {
+	char host_format[256];
+	u32 out = 0;
+	int in_spec = 0;
+
+	for (const char* p = format; *p && out < sizeof(host_format) - 1; p++) {
+		if (*p == '%') {
+			in_spec = !in_spec;
+		}
+		else if (in_spec && *p == 'l') {
+			continue;
+		}
+		else if (in_spec && ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z'))) {
+			in_spec = 0;
+		}
+		host_format[out++] = *p;
+	}
+	host_format[out] = '\0';
+
+	va_list args;
+	va_start(args, format);
+	vprintf(host_format, args);
+	va_end(args);
+}
@@ -0,0 +1,23 @@
+#ifndef HOST_IO_H
+#define HOST_IO_H
+
+#include <stdint.h>
+#include "xil_types.h"
+
+// ============================================================================
+// SIMULATED STREAM GRABBER
+// ============================================================================
+// Xil_In32()/Xil_Out32() on the stream grabber registers behave like the
+// hardware as seen by sampling_ISR():
+//   BASEADDR + 4 (write)  select the capture to read (ignored, always the current one)
+//   BASEADDR + 8 (read)   raw mic value of the current capture
+//   BASEADDR     (write)  restart the grabber -> the next read returns the next sample
+// Past the end of the loaded samples the last one is held.
+
+// Load the raw mic values the grabber will return (not copied; must outlive the run)
+void host_grabber_load(const int32_t* samples, u32 count);
+
+// Number of grabber restarts (= samples consumed) since host_grabber_load()
+u32 host_grabber_position(void);
+
+#endif // HOST_IO_H
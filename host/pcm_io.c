@@ -0,0 +1,158 @@
+#include "pcm_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// LITTLE-ENDIAN HELPERS
+// ============================================================================
+static u32 get_le32(const u8* p) {
+	return (u32) p[0] | ((u32) p[1] << 8) | ((u32) p[2] << 16) | ((u32) p[3] << 24);
+}
+
+static u16 get_le16(const u8* p) {
+	return (u16) (p[0] | (p[1] << 8));
+}
+
+static void put_le32(u8* p, u32 v) {
+	p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; p[2] = (v >> 16) & 0xFF; p[3] = (v >> 24) & 0xFF;
+}
+
+static void put_le16(u8* p, u16 v) {
+	p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF;
+}
+
+// ============================================================================
+// READ
+// ============================================================================
+static int load_file(const char* path, u8** data, u32* size) {
+	FILE* f = fopen(path, "rb");
+	if (!f) {
+		fprintf(stderr, "%s: cannot open\n", path);
+		return -1;
+	}
+	fseek(f, 0, SEEK_END);
+	long length = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	*data = malloc(length > 0 ? (size_t) length : 1);
+	if (!*data || fread(*data, 1, (size_t) length, f) != (size_t) length) {
+		fprintf(stderr, "%s: read failed\n", path);
+		free(*data);
+		fclose(f);
+		return -1;
+	}
+	fclose(f);
+	*size = (u32) length;
+	return 0;
+}
+
+// Locate the sample data of a 16-bit mono PCM WAV file
+static int find_wav_data(const char* path, const u8* file, u32 size, u32* offset, u32* bytes) {
+	int have_format = 0;
+	u32 pos = 12;
+
+	while (pos + 8 <= size) {
+		u32 chunk_size = get_le32(file + pos + 4);
+		const u8* chunk = file + pos + 8;
+		if (chunk_size > size - pos - 8) chunk_size = size - pos - 8; // truncated file: take what's there
+
+		if (memcmp(file + pos, "fmt ", 4) == 0 && chunk_size >= 16) {
+			u16 format = get_le16(chunk);
+			u16 channels = get_le16(chunk + 2);
+			u16 bits = get_le16(chunk + 14);
+			if (format != 1 || channels != 1 || bits != 16) {
+				fprintf(stderr, "%s: only 16-bit mono PCM WAV is supported (format %u, %u channels, %u bits)\n",
+						path, format, channels, bits);
+				return -1;
+			}
+			have_format = 1;
+		}
+		else if (memcmp(file + pos, "data", 4) == 0) {
+			if (!have_format) break;
+			*offset = pos + 8;
+			*bytes = chunk_size;
+			return 0;
+		}
+		pos += 8 + chunk_size + (chunk_size & 1); // chunks are padded to an even size
+	}
+
+	fprintf(stderr, "%s: no fmt/data chunk\n", path);
+	return -1;
+}
+
+int pcm_read(const char* path, int16_t** samples, u32* count) {
+	u8* file;
+	u32 size;
+	if (load_file(path, &file, &size) != 0) {
+		return -1;
+	}
+
+	u32 offset = 0;
+	u32 bytes = size;
+	if (size >= 12 && memcmp(file, "RIFF", 4) == 0 && memcmp(file + 8, "WAVE", 4) == 0) {
+		if (find_wav_data(path, file, size, &offset, &bytes) != 0) {
+			free(file);
+			return -1;
+		}
+	}
+
+	*count = bytes / 2;
+	*samples = malloc(*count > 0 ? *count * sizeof(int16_t) : 1);
+	if (!*samples) {
+		free(file);
+		return -1;
+	}
+	for (u32 i = 0; i < *count; i++) {
+		(*samples)[i] = (int16_t) get_le16(file + offset + 2 * i);
+	}
+
+	free(file);
+	return 0;
+}
+
+// ============================================================================
+// WRITE
+// ============================================================================
+static int is_wav_path(const char* path) {
+	size_t length = strlen(path);
+	return length >= 4 && strcmp(path + length - 4, ".wav") == 0;
+}
+
+int pcm_write(const char* path, const int16_t* samples, u32 count, u32 sample_rate) {
+	FILE* f = fopen(path, "wb");
+	if (!f) {
+		fprintf(stderr, "%s: cannot create\n", path);
+		return -1;
+	}
+
+	int ok = 1;
+	if (is_wav_path(path)) {
+		u8 header[44];
+		memcpy(header, "RIFF", 4);
+		put_le32(header + 4, 36 + count * 2);
+		memcpy(header + 8, "WAVEfmt ", 8);
+		put_le32(header + 16, 16);
+		put_le16(header + 20, 1);               // PCM
+		put_le16(header + 22, 1);               // mono
+		put_le32(header + 24, sample_rate);
+		put_le32(header + 28, sample_rate * 2); // byte rate
+		put_le16(header + 32, 2);               // block align
+		put_le16(header + 34, 16);              // bits per sample
+		memcpy(header + 36, "data", 4);
+		put_le32(header + 40, count * 2);
+		ok = fwrite(header, 1, sizeof(header), f) == sizeof(header);
+	}
+
+	for (u32 i = 0; ok && i < count; i++) {
+		u8 sample[2];
+		put_le16(sample, (u16) samples[i]);
+		ok = fwrite(sample, 1, 2, f) == 2;
+	}
+
+	if (fclose(f) != 0 || !ok) {
+		fprintf(stderr, "%s: write failed\n", path);
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef PCM_IO_H
+#define PCM_IO_H
+
+#include <stdint.h>
+#include "xil_types.h"
+
+// ============================================================================
+// PCM FILE I/O
+// ============================================================================
+// Mono 16-bit PCM, either as a RIFF/WAVE file (16-bit PCM, mono) or as headerless
+// little-endian raw samples. Reading detects the format from the RIFF header;
+// writing picks WAV when the path ends in ".wav", raw otherwise.
+
+// Read a whole file into a malloc'd buffer (caller frees *samples)
+// Returns: 0 on success, -1 on error (message already printed to stderr)
+int pcm_read(const char* path, int16_t** samples, u32* count);
+
+// Write 'count' samples; sample_rate only goes into the WAV header
+// Returns: 0 on success, -1 on error (message already printed to stderr)
+int pcm_write(const char* path, const int16_t* samples, u32 count, u32 sample_rate);
+
+#endif // PCM_IO_H
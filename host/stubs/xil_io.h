@@ -0,0 +1,13 @@
+#ifndef XIL_IO_H
+#define XIL_IO_H
+
+#include "xil_types.h"
+
+// Host stand-in for Xil_In32()/Xil_Out32()
+// Only the mic stream grabber is modelled (see host_io.c); any other address
+// reads as 0 and ignores writes.
+
+u32 Xil_In32(UINTPTR addr);
+void Xil_Out32(UINTPTR addr, u32 value);
+
+#endif // XIL_IO_H
@@ -0,0 +1,7 @@
+#ifndef XIL_PRINTF_H
+#define XIL_PRINTF_H
+
+// Host stand-in for xil_printf(); forwards to stdout (see host_io.c)
+void xil_printf(const char* format, ...);
+
+#endif // XIL_PRINTF_H
@@ -0,0 +1,20 @@
+#ifndef XIL_TYPES_H
+#define XIL_TYPES_H
+
+// Host stand-in for the standalone BSP's xil_types.h (same widths as the MicroBlaze build)
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef uintptr_t UINTPTR;
+typedef u32 Xuint32;
+
+#endif // XIL_TYPES_H
@@ -0,0 +1,7 @@
+#ifndef XPARAMETERS_H
+#define XPARAMETERS_H
+
+// Host stand-in: only the addresses the DSP path touches
+#define XPAR_MIC_BLOCK_STREAM_GRABBER_0_BASEADDR 0x00020000
+
+#endif // XPARAMETERS_H
@@ -0,0 +1,43 @@
+#!/bin/sh
+# Report which symbols landed in LMB BRAM vs DDR, with their sizes.
+#
+# usage: tools/mem_report.sh <application.elf> [all]
+#   default: hot-path symbols only (sampling_ISR, process_*, filter/LFO state, sine table,
+#            delay windows) plus a per-region total
+#   all:     every sized symbol in the image
+#
+# Uses mb-nm from the Vitis toolchain; set NM to override (e.g. NM=nm for a host build).
+# Regions follow lscript.ld: LMB BRAM is 0x00000000-0x0000FFFF, DDR starts at 0x80000000.
+
+ELF="$1"
+MODE="${2:-hot}"
+NM="${NM:-mb-nm}"
+
+if [ -z "$ELF" ] || [ ! -f "$ELF" ]; then
+	echo "usage: $0 <application.elf> [all]" >&2
+	exit 1
+fi
+
+HOT='sampling_ISR|fast_interrupt|^process_|_kernel$|condition_input|audio_process|limit_output|block_engine|lfo_sine_quarter|_filter_state|_filter_coeff|dc_bias|tiny_buffer|input_average|lfo_bank|lfo_out|tape_tone_state|duck_envelope|short_storage|short_line|chorus_allpass_state|circular_buffer_fast|input_line|block_.*_storage|block_work|delay_line|active_tap|fade_tap|smoothed_params|looper_window|chunks_done|chunks_ready|chunk_pos|slot_mode'
+
+"$NM" -S -n "$ELF" | awk -v mode="$MODE" -v hot="$HOT" '
+function hex(s,    i, v) {
+	v = 0
+	s = tolower(s)
+	for (i = 1; i <= length(s); i++) v = v * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+	return v
+}
+NF == 4 {
+	addr = hex($1); size = hex($2); type = $3; name = $4
+	if (addr < 65536) region = "LMB"
+	else if (addr >= 2147483648) region = "DDR"
+	else region = "IO?"
+	total[region] += size
+	if (mode != "all" && name !~ hot) next
+	kind = (type ~ /[tTwW]/) ? "code" : "data"
+	flag = (region == "DDR" && mode != "all") ? "  <-- hot symbol in DDR" : ""
+	printf "%-4s %-4s 0x%08x %7d  %s%s\n", region, kind, addr, size, name, flag
+}
+END {
+	printf "\nLMB total: %d bytes (of 65456)\nDDR total: %d bytes\n", total["LMB"], total["DDR"]
+}'
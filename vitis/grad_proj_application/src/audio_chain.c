@@ -0,0 +1,386 @@
+#include "audio_chain.h"
+#include "delay.h"
+#include "tremolo.h"
+#include "chorus.h"
+#include "mem_placement.h"
+#include "block_engine.h"
+#include "isr_profile.h"
+#include "moving_average.h"
+#include "param_smooth.h"
+#include "looper.h"
+#include "lfo.h"
+
+// Stage marks only make sense when the chain runs inside sampling_ISR(); in block mode
+// the block engine times each whole block as PROF_BLOCK instead
+#if BLOCK_PROCESSING
+#define CHAIN_MARK(stage)
+#else
+#define CHAIN_MARK(stage) PROF_MARK(stage)
+#endif
+
+// variables for circular buffer
+// only ever touched from one context (sampling_ISR, or the main loop in block mode), so not volatile
+// the full line lives in DDR; the most recent DELAY_LINE_FAST_SIZE samples are mirrored in BRAM
+static delay_sample_t circular_buffer[DELAY_LINE_SIZE] = {0};
+static delay_sample_t circular_buffer_fast[DELAY_LINE_FAST_SIZE] FAST_DATA = {0};
+delay_line_t input_line FAST_DATA = { circular_buffer, 0, 0, circular_buffer_fast, DELAY_LINE_FAST_SIZE };
+
+// variables used for printing statistics and collecting the DC offset of the raw data
+volatile int32_t curr_sample FAST_DATA = 0;
+#if INPUT_AVERAGE_LENGTH == 5
+static int32_t tiny_buffer[5] FAST_DATA = {0,0,0,0,0};
+static int tiny_buffer_index FAST_DATA = 0;
+#else
+static moving_average_t input_average FAST_DATA;
+#endif
+static int32_t dc_bias_drift FAST_DATA = 0;
+static int32_t dc_bias_static FAST_DATA = 0;
+static int first_run FAST_DATA = 1; // just a simple flag
+static int32_t hp_filter_state FAST_DATA = 0;
+static int32_t lp_filter_state FAST_DATA = 0;
+static int32_t lp_filter_state_2 FAST_DATA = 0;
+static int32_t lp_filter_state_3 FAST_DATA = 0;
+static u32 smooth_countdown FAST_DATA = 0; // per-sample mode: samples until the next param_smooth_tick()
+
+// hpf/lpf variables
+volatile u16 lp_filter_coeff FAST_DATA = LP_FILTER_COEFF_DEFAULT;
+volatile u16 hp_filter_coeff FAST_DATA = HP_FILTER_COEFF_DEFAULT;
+
+// ============================================================================
+// FILTERS AND INPUT LIMITER
+// ============================================================================
+// HPF and LPF cascade on the DC-free signal
+// Returns: the filtered signal scaled down to the limiter's range
+static inline FAST_CODE int32_t filter_input(int32_t audio_signal) {
+    // smoothed copies of hp_filter_coeff / lp_filter_coeff (see param_smooth.h)
+    int32_t hp_coeff = (int32_t) smoothed_value(SMOOTH_HP_COEFF);
+    int32_t lp_coeff = (int32_t) smoothed_value(SMOOTH_LP_COEFF);
+
+    // HIGH-PASS FILTER (removes low-frequency rumble)
+    hp_filter_state = hp_filter_state + ((audio_signal - hp_filter_state) * hp_coeff >> 8);
+	// HPF = original signal - LPF; hp_filter_state is the LPF and subtracting it from 'audio_signal' returns the actual HPF signal
+    int32_t filtered_signal = audio_signal - hp_filter_state;
+    CHAIN_MARK(PROF_HPF);
+
+    // two cascaded LPF filter (which forms a 2nd order filter) to remove high frequency squeals
+    lp_filter_state = lp_filter_state + ((filtered_signal - lp_filter_state) * lp_coeff >> 8);
+    lp_filter_state_2 = lp_filter_state_2 + ((lp_filter_state - lp_filter_state_2) * lp_coeff >> 8);
+    lp_filter_state_3 = lp_filter_state_3 + ((lp_filter_state_2 - lp_filter_state_3) * lp_coeff >> 8);
+    CHAIN_MARK(PROF_LPF);
+
+    // now that we preserve the sign, we can shift safely
+	// scale the signal down to a nice number ideally between -1024 and 1024
+    // int32_t scaled_signal = audio_signal >> 16; // change num back to 15 if it sounds bad
+    int32_t scaled_signal = lp_filter_state_3 >> 16; // revert back to 17if necessary
+
+    return scaled_signal;
+}
+
+static inline FAST_CODE int32_t limit_input(int32_t scaled_signal) {
+    // INPUT LIMITER (prevents clipping in processing chain)
+    // Soft limiter: compress signal above threshold, which enables "soft clipping" (sounds better than maxing out the signal)
+	// JW Note: on Wed, we should print out scaled_signal at a fast rate to see how we can set a good INPUT LIMIT THRESHOLD
+    int32_t limited_signal = scaled_signal;
+    if (limited_signal > INPUT_LIMIT_THRESHOLD) {
+        // Soft compression: threshold + (excess / 4)
+        limited_signal = INPUT_LIMIT_THRESHOLD + ((limited_signal - INPUT_LIMIT_THRESHOLD) >> 2);
+    }
+    else if (limited_signal < -INPUT_LIMIT_THRESHOLD) {
+        limited_signal = -INPUT_LIMIT_THRESHOLD + ((limited_signal + INPUT_LIMIT_THRESHOLD) >> 2);
+    }
+
+    return limited_signal;
+}
+
+// ============================================================================
+// INPUT CONDITIONING
+// ============================================================================
+FAST_CODE int32_t condition_input(int32_t new_sample) {
+    int32_t smoothed_sample;
+#if INPUT_AVERAGE_LENGTH == 5
+	// tiny_buffer holds the most recent 5 samples, which is used to calculate a rolling average
+	tiny_buffer[tiny_buffer_index] = new_sample;
+	tiny_buffer_index = (tiny_buffer_index + 1) % 5;
+
+    // set first sample from mic as the dc_bias
+    if (first_run) {
+		for(int i=0; i<5; i++) tiny_buffer[i] = new_sample;
+        dc_bias_static = new_sample;
+		dc_bias_drift = new_sample;
+		smoothed_sample = new_sample;
+        first_run = 0;
+    }
+	else {
+		// calculate average immediately
+		int32_t sum = 0;
+		for (int i = 0; i < 5; i++) {
+			sum += tiny_buffer[i];
+		}
+		smoothed_sample = sum / 5;
+	}
+#else
+    // set first sample from mic as the dc_bias (and fill the averaging window with it)
+    if (first_run) {
+    	moving_average_init(&input_average, INPUT_AVERAGE_LENGTH, new_sample);
+        dc_bias_static = new_sample;
+		dc_bias_drift = new_sample;
+		smoothed_sample = new_sample;
+        first_run = 0;
+    }
+	else {
+		// O(1) running sum; the divide is a shift
+		smoothed_sample = moving_average_push(&input_average, new_sample);
+	}
+#endif
+	// Update global variable with the SMOOTHED value (logging only; the math below uses the local)
+	curr_sample = smoothed_sample;
+
+    // moving average of the dc_bias to track it
+    dc_bias_drift += (smoothed_sample - dc_bias_drift) >> 10;
+    if ((dc_bias_drift > smoothed_sample + 1000000) || (dc_bias_drift < smoothed_sample - 1000000)) {
+    	dc_bias_drift = dc_bias_static;
+    }
+
+    // remove the DC offset from the current sample
+    int32_t audio_signal = smoothed_sample - dc_bias_drift;
+    CHAIN_MARK(PROF_DC_REMOVAL);
+
+    int32_t scaled_signal = filter_input(audio_signal);
+
+    int32_t limited_signal = limit_input(scaled_signal);
+    CHAIN_MARK(PROF_LIMITER);
+
+    return limited_signal;
+}
+
+// ============================================================================
+// OUTPUT LIMITER
+// ============================================================================
+static inline FAST_CODE int32_t limit_output(int32_t mixed_signal) {
+     int32_t output_signal = mixed_signal;
+     if (output_signal > OUTPUT_LIMIT_THRESHOLD) {
+     	output_signal = OUTPUT_LIMIT_THRESHOLD;
+     }
+     else if (output_signal < -OUTPUT_LIMIT_THRESHOLD) {
+     	output_signal = -OUTPUT_LIMIT_THRESHOLD;
+     }
+     return output_signal;
+}
+
+// ============================================================================
+// SINGLE STAGES
+// ============================================================================
+// Out-of-line entry points to the inlined stages, so each one can be timed on its own
+FAST_CODE int32_t audio_filter_input(int32_t audio_signal) {
+	return filter_input(audio_signal);
+}
+
+FAST_CODE int32_t audio_limit_input(int32_t scaled_signal) {
+	return limit_input(scaled_signal);
+}
+
+FAST_CODE int32_t audio_limit_output(int32_t mixed_signal) {
+	return limit_output(mixed_signal);
+}
+
+// ============================================================================
+// LFO SELECTION
+// ============================================================================
+// Returns: the LFOs the enabled effects will read this run (the rest only advance)
+// An effect switched on between here and its stage reads stale values for one run,
+// like any other parameter change enc_ISR() makes mid-block.
+static inline FAST_CODE u32 lfo_active(void) {
+	u32 active = 0;
+	if (tremolo_enabled) {
+		active |= LFO_BIT(LFO_TREMOLO);
+	}
+	if (chorus_enabled) {
+		// the flanger and vibrato run voice 1 only
+		u32 voices = (chorus_style == CHORUS_STYLE_CHORUS) ? chorus_voices : 1;
+		active |= (LFO_BIT(voices) - 1) << LFO_CHORUS;
+	}
+	if (delay_enabled && delay_tape && !delay_reverse) {
+		active |= LFO_BIT(LFO_TAPE_WOW) | LFO_BIT(LFO_TAPE_FLUTTER);
+	}
+	return active;
+}
+
+// ============================================================================
+// PER-SAMPLE PROCESSING
+// ============================================================================
+FAST_CODE int32_t audio_process_sample(int32_t new_sample) {
+	if (smooth_countdown == 0) {
+		param_smooth_tick();
+		smooth_countdown = PARAM_SMOOTH_INTERVAL;
+	}
+	smooth_countdown--;
+	lfo_bank_run(1, lfo_active());
+
+	int32_t limited_signal = condition_input(new_sample);
+
+    delay_line_write(&input_line, limited_signal);
+
+    int32_t mixed_signal = limited_signal;
+    if (delay_enabled && (input_line.samples_written > delay_samples)) {
+    	mixed_signal = process_delay(mixed_signal);
+    }
+    else {
+    	feed_delay(limited_signal);
+    }
+    CHAIN_MARK(PROF_DELAY);
+
+    if (tremolo_enabled) {
+    	mixed_signal = process_tremolo(mixed_signal);
+    }
+    CHAIN_MARK(PROF_TREMOLO);
+
+    if (chorus_enabled && (input_line.samples_written > chorus_history())) {
+    	mixed_signal = process_chorus(mixed_signal, &input_line);
+    }
+    CHAIN_MARK(PROF_CHORUS);
+
+    // the looper records (and plays under) everything the effects produced
+    mixed_signal = process_looper(mixed_signal);
+    CHAIN_MARK(PROF_LOOPER);
+
+    int32_t output_signal = limit_output(mixed_signal);
+    CHAIN_MARK(PROF_OUTPUT_LIMITER);
+
+    return output_signal;
+}
+
+#if AUDIO_CHANNELS > 1
+// ============================================================================
+// PER-FRAME PROCESSING
+// ============================================================================
+// Same stages as audio_process_sample(), but the delay comes last: it is the stage
+// that spreads the mono signal over the channels, so it sees the tremolo, chorus and
+// looper output and everything after it runs once per channel
+FAST_CODE void audio_process_frame(int32_t new_sample, int32_t* frame) {
+	if (smooth_countdown == 0) {
+		param_smooth_tick();
+		smooth_countdown = PARAM_SMOOTH_INTERVAL;
+	}
+	smooth_countdown--;
+	lfo_bank_run(1, lfo_active());
+
+	int32_t limited_signal = condition_input(new_sample);
+
+    delay_line_write(&input_line, limited_signal);
+
+    int32_t mixed_signal = limited_signal;
+    if (tremolo_enabled) {
+    	mixed_signal = process_tremolo(mixed_signal);
+    }
+    CHAIN_MARK(PROF_TREMOLO);
+
+    if (chorus_enabled && (input_line.samples_written > chorus_history())) {
+    	mixed_signal = process_chorus(mixed_signal, &input_line);
+    }
+    CHAIN_MARK(PROF_CHORUS);
+
+    mixed_signal = process_looper(mixed_signal);
+    CHAIN_MARK(PROF_LOOPER);
+
+    if (delay_enabled && (input_line.samples_written > delay_samples)) {
+    	process_delay_frame(mixed_signal, frame);
+    }
+    else {
+    	feed_delay_frame(mixed_signal);
+    	for (u32 ch = 0; ch < AUDIO_CHANNELS; ch++) {
+    		frame[ch] = mixed_signal;
+    	}
+    }
+    CHAIN_MARK(PROF_DELAY);
+
+    for (u32 ch = 0; ch < AUDIO_CHANNELS; ch++) {
+    	frame[ch] = limit_output(frame[ch]);
+    }
+    CHAIN_MARK(PROF_OUTPUT_LIMITER);
+}
+#endif
+
+// ============================================================================
+// BLOCK PROCESSING
+// ============================================================================
+// Number of leading samples in a block that are still inside an effect's warm-up
+// window (per-sample mode only runs an effect once samples_written > needed)
+static inline FAST_CODE u32 warmup_skip(u32 written_before, u32 count, u32 needed) {
+	if (written_before >= needed) return 0;
+	if ((needed - written_before) >= count) return count;
+	return needed - written_before;
+}
+
+// Same chain as audio_process_sample(), but each stage runs over the whole block
+// so the per-effect call overhead (and the enable checks) are paid once per block.
+// The whole block is written to the delay line before the effects run; the block
+// effects read each sample's taps relative to where that sample sits in the line,
+// so the output matches per-sample mode exactly.
+FAST_CODE void audio_process_block(int32_t *samples, u32 count) {
+	u32 written_before = input_line.samples_written;
+
+	param_smooth_tick();
+	lfo_bank_run(count, lfo_active());
+
+	for (u32 i = 0; i < count; i++) {
+		int32_t limited_signal = condition_input(samples[i]);
+		samples[i] = limited_signal;
+		delay_line_write(&input_line, limited_signal);
+	}
+
+    if (delay_enabled) {
+    	u32 skip = warmup_skip(written_before, count, delay_samples);
+    	feed_delay_block(samples, skip);
+    	if (skip < count) {
+    		process_delay_block(samples + skip, count - skip);
+    	}
+    }
+    else {
+    	feed_delay_block(samples, count);
+    }
+
+    if (tremolo_enabled) {
+    	process_tremolo_block(samples, count);
+    }
+
+    if (chorus_enabled) {
+    	u32 skip = warmup_skip(written_before, count, chorus_history());
+    	if (skip < count) {
+    		process_chorus_block(samples + skip, count - skip, &input_line);
+    	}
+    }
+
+    process_looper_block(samples, count);
+
+    for (u32 i = 0; i < count; i++) {
+    	samples[i] = limit_output(samples[i]);
+    }
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+void init_audio_chain(void) {
+#if INPUT_AVERAGE_LENGTH == 5
+	for (int i = 0; i < 5; i++) tiny_buffer[i] = 0;
+	tiny_buffer_index = 0;
+#endif
+	curr_sample = 0;
+	dc_bias_drift = 0;
+	dc_bias_static = 0;
+	first_run = 1;
+	hp_filter_state = 0;
+	lp_filter_state = 0;
+	lp_filter_state_2 = 0;
+	lp_filter_state_3 = 0;
+	hp_filter_coeff = HP_FILTER_COEFF_DEFAULT;
+	lp_filter_coeff = LP_FILTER_COEFF_DEFAULT;
+	smooth_countdown = 0;
+	init_param_smooth();
+	init_lfo_bank();
+	init_looper();
+
+	for (u32 i = 0; i < DELAY_LINE_SIZE; i++) circular_buffer[i] = 0;
+	for (u32 i = 0; i < DELAY_LINE_FAST_SIZE; i++) circular_buffer_fast[i] = 0;
+	delay_line_init(&input_line, circular_buffer, circular_buffer_fast);
+}
@@ -0,0 +1,104 @@
+#ifndef AUDIO_CHAIN_H
+#define AUDIO_CHAIN_H
+
+#include <stdint.h>
+#include "xil_types.h"
+#include "delay_line.h"
+
+// ============================================================================
+// AUDIO CHAIN CONFIGURATION
+// ============================================================================
+// The audio chain is everything between the raw mic sample and the signed
+// output sample: input smoothing, DC removal, HPF, LPF cascade, input limiter,
+// effects (delay, tremolo, chorus), the looper and the output limiter.
+// It has no hardware dependencies so it can be run per sample from sampling_ISR()
+// or per block from the block engine (see block_engine.h)
+
+// Input smoothing ahead of DC removal
+// 4, 8 or 16: running-sum moving average of that many raw samples (see moving_average.h)
+// 5:          the original loop that re-sums a 5-sample window and divides by 5 every
+//             sample (kept for comparison)
+#ifndef INPUT_AVERAGE_LENGTH
+#define INPUT_AVERAGE_LENGTH 4
+#endif
+
+#if (INPUT_AVERAGE_LENGTH != 4) && (INPUT_AVERAGE_LENGTH != 5) && (INPUT_AVERAGE_LENGTH != 8) && (INPUT_AVERAGE_LENGTH != 16)
+#error "INPUT_AVERAGE_LENGTH must be 4, 8, 16 or 5 (original 5-tap loop)"
+#endif
+
+// Output channels
+// 1: mono, audio_process_sample()/audio_process_block() (the board's single PWM)
+// 2: stereo, audio_process_frame(): the chain runs mono up to the delay, which becomes
+//    a ping-pong delay (delay.h) whose repeats alternate between the channels. Each
+//    channel costs one more read/write in the same interleaved frame of the delay
+//    line, one output limiter and one PWM register write; nothing else is duplicated.
+//    Needs a PWM timer per channel (bsp.h).
+#ifndef AUDIO_CHANNELS
+#define AUDIO_CHANNELS 1
+#endif
+
+#if (AUDIO_CHANNELS < 1) || (AUDIO_CHANNELS > 2)
+#error "AUDIO_CHANNELS must be 1 (mono) or 2 (stereo)"
+#endif
+
+// Filter coefficient ranges (0-256 scale)
+#define HP_FILTER_COEFF_MIN  1   // less filtering (removes less low frequencies)
+#define HP_FILTER_COEFF_MAX  256  // more filtering (removes more low frequencies)
+#define HP_FILTER_COEFF_DEFAULT  10
+
+#define LP_FILTER_COEFF_MIN  1   // More filtering (removes more high frequencies)
+#define LP_FILTER_COEFF_MAX  256 // Less filtering (removes fewer high frequencies)
+#define LP_FILTER_COEFF_DEFAULT  90
+
+#define FILTER_COEFF_ADJUST_STEP  2  // Step size for encoder adjustment
+
+#define INPUT_LIMIT_THRESHOLD 400
+#define OUTPUT_LIMIT_THRESHOLD 400
+
+// ============================================================================
+// AUDIO CHAIN STATE VARIABLES
+// ============================================================================
+
+// Filter coefficients (adjustable via buttons)
+extern volatile u16 hp_filter_coeff;
+extern volatile u16 lp_filter_coeff;
+
+// logging variables
+extern volatile int32_t curr_sample;    // latest smoothed raw sample
+
+// delay line of conditioned input samples (read by the chorus; the delay keeps its own feedback line)
+extern delay_line_t input_line;
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+
+// Smoothing, DC removal, HPF, LPF cascade and input limiter
+// Returns: conditioned sample, roughly between -1024 and 1024
+int32_t condition_input(int32_t new_sample);
+
+// Single stages of condition_input()/audio_process_sample(), for timing them in isolation
+// (they share the chain's filter state)
+int32_t audio_filter_input(int32_t audio_signal);   // HPF + LPF cascade + scaling
+int32_t audio_limit_input(int32_t scaled_signal);   // soft input limiter
+int32_t audio_limit_output(int32_t mixed_signal);   // hard output limiter
+
+// Run one raw mic sample through the whole chain
+// Returns: signed output sample (limited to +/- OUTPUT_LIMIT_THRESHOLD)
+int32_t audio_process_sample(int32_t new_sample);
+
+#if AUDIO_CHANNELS > 1
+// Run one raw mic sample through the stereo chain: conditioning, tremolo, chorus and
+// looper on the mono signal, then the ping-pong delay and a limiter per channel
+// frame: AUDIO_CHANNELS output samples (each limited to +/- OUTPUT_LIMIT_THRESHOLD)
+void audio_process_frame(int32_t new_sample, int32_t* frame);
+#endif
+
+// Run a block of raw mic samples through the whole chain, in place
+// Each effect is run over the whole block before the next one starts
+void audio_process_block(int32_t *samples, u32 count);
+
+// Reset filter state, DC tracking, the input delay line and the looper (next sample is treated as the first)
+void init_audio_chain(void);
+
+#endif // AUDIO_CHAIN_H
@@ -0,0 +1,371 @@
+#include "bench.h"
+
+#if BENCHMARK
+
+#include "audio_chain.h"
+#include "block_engine.h"
+#include "delay.h"
+#include "tremolo.h"
+#include "chorus.h"
+#include "param_smooth.h"
+#include "lfo.h"
+#include "xil_printf.h"
+
+// ============================================================================
+// TIME BASE
+// ============================================================================
+#ifdef __MICROBLAZE__
+#include "cycle_timer.h"
+#include "mb_interface.h"
+
+typedef u32 bench_ticks_t; // one row must finish within one counter wrap (~43 s)
+#define BENCH_TICK_HZ  CYCLE_TIMER_FREQ_HZ
+#define BENCH_UNIT     "cycles"
+
+static inline bench_ticks_t bench_now(void) {
+	return cycle_timer_read();
+}
+#else
+#include <time.h>
+
+typedef u64 bench_ticks_t;
+#define BENCH_TICK_HZ  1000000000u
+#define BENCH_UNIT     "ns"
+
+static inline bench_ticks_t bench_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (u64) now.tv_sec * 1000000000u + (u64) now.tv_nsec;
+}
+#endif
+
+#define BENCH_SAMPLE_RATE 48828 // match system sample rate
+
+// ============================================================================
+// INPUT SIGNALS
+// ============================================================================
+// Both tables are replayed in a loop; they fit in the D-cache so the input itself
+// costs the same in every row (see the baseline row)
+#define BENCH_TABLE_SIZE 1024 // must be power of 2
+#define BENCH_TABLE_MASK (BENCH_TABLE_SIZE - 1)
+
+static int32_t raw_table[BENCH_TABLE_SIZE];     // raw mic values: DC bias + signal, for condition_input()
+static int32_t signal_table[BENCH_TABLE_SIZE];  // conditioned-range samples, past both limiter thresholds
+static volatile int32_t bench_sink;             // keeps the compiler from dropping the kernels
+
+static void init_tables(void) {
+	u32 noise = 1;
+	for (u32 i = 0; i < BENCH_TABLE_SIZE; i++) {
+		// triangle of +/-600 plus a little noise
+		int32_t phase = (int32_t) (i & 511);
+		int32_t triangle = (i & 512) ? 600 - (phase * 1200) / 512 : -600 + (phase * 1200) / 512;
+		noise = noise * 1664525u + 1013904223u;
+		int32_t sample = triangle + (int32_t) (noise >> 25) - 64;
+
+		signal_table[i] = sample;
+		raw_table[i] = 0x04000000 + sample * (1 << 15);
+	}
+}
+
+// ============================================================================
+// KERNELS
+// ============================================================================
+// Effects that read the input line also write to it, as audio_process_sample() does
+// (the delay writes its own feedback line)
+static int32_t bench_baseline(int32_t x) {
+	return x;
+}
+
+static int32_t bench_line_write(int32_t x) {
+	delay_line_write(&input_line, x);
+	return x;
+}
+
+static int32_t bench_chorus(int32_t x) {
+	delay_line_write(&input_line, x);
+	return process_chorus(x, &input_line);
+}
+
+// The whole bank for one sample, as audio_process_sample() runs it (the effect rows
+// below call their process_* directly, so they leave the LFOs out)
+static int32_t bench_lfo_bank(int32_t x) {
+	lfo_bank_run(1, LFO_ALL);
+	return x + lfo_out[LFO_TREMOLO][0];
+}
+
+// Read heads on a delay that sweeps slowly between 1000 and 1300 samples with a
+// changing fraction, like a chorus tap (reads only; the line is primed by bench_run())
+#define BENCH_READ_BASE_Q16  (1000u << 16)
+#define BENCH_READ_SPAN_Q16  (300u << 16)
+#define BENCH_READ_STEP_Q16  0x1357u
+
+static u32 bench_read_delay_q16 = BENCH_READ_BASE_Q16;
+static int32_t bench_allpass_state;
+
+static inline u32 bench_next_read_delay(void) {
+	bench_read_delay_q16 += BENCH_READ_STEP_Q16;
+	if (bench_read_delay_q16 >= BENCH_READ_BASE_Q16 + BENCH_READ_SPAN_Q16) {
+		bench_read_delay_q16 -= BENCH_READ_SPAN_Q16;
+	}
+	return bench_read_delay_q16;
+}
+
+static int32_t bench_read_none(int32_t x) {
+	return x + delay_line_read(&input_line, bench_next_read_delay() >> 16);
+}
+
+static int32_t bench_read_linear(int32_t x) {
+	return x + delay_line_read_linear(&input_line, bench_next_read_delay());
+}
+
+static int32_t bench_read_allpass(int32_t x) {
+	return x + delay_line_read_allpass(&input_line, bench_next_read_delay(), &bench_allpass_state);
+}
+
+static int32_t bench_read_hermite(int32_t x) {
+	return x + delay_line_read_hermite(&input_line, bench_next_read_delay());
+}
+
+// ============================================================================
+// PARAMETER SETTERS
+// ============================================================================
+static void set_none(u32 value) {
+}
+
+// every LFO in the bank on the same waveform
+static void set_lfo_waveform(u32 value) {
+	for (u32 k = 0; k < LFO_COUNT; k++) {
+		lfo_set_waveform((lfo_id_t) k, (lfo_waveform_t) value);
+	}
+}
+
+static void set_hp_coeff(u32 value) {
+	hp_filter_coeff = value;
+}
+
+static void set_lp_coeff(u32 value) {
+	lp_filter_coeff = value;
+}
+
+static void set_delay_samples(u32 value) {
+	delay_samples = value;
+}
+
+static void set_delay_feedback(u32 value) {
+	delay_feedback = value;
+}
+
+// selects the preset with 'value' taps, so the row shows the cost of each extra tap
+static void set_delay_taps(u32 value) {
+	for (u32 p = 0; p < DELAY_PATTERN_COUNT; p++) {
+		if (delay_patterns[p].count == value) delay_pattern = p;
+	}
+}
+
+static void set_tremolo_rate(u32 value) {
+	tremolo_rate = value;
+	update_tremolo_phase_inc();
+}
+
+static void set_chorus_depth(u32 value) {
+	chorus_depth = value;
+}
+
+static void set_chorus_delay(u32 value) {
+	chorus_delay = value;
+}
+
+static void set_chorus_voices(u32 value) {
+	chorus_voices = value;
+	update_chorus_spread();
+}
+
+// (negative feedback costs the same as positive)
+static void set_flanger_feedback(u32 value) {
+	set_chorus_style(CHORUS_STYLE_FLANGER);
+	flanger_feedback = (int32_t) value;
+}
+
+static void set_vibrato_depth(u32 value) {
+	set_chorus_style(CHORUS_STYLE_VIBRATO);
+	vibrato_depth = value;
+}
+
+static void set_delay_duck(u32 value) {
+	delay_duck = value;
+}
+
+static void set_tape_delay(u32 value) {
+	delay_tape = 1;
+	delay_samples = value;
+}
+
+static void set_reverse_chunk(u32 value) {
+	delay_reverse = 1;
+	delay_samples = value;
+}
+
+// bit 0 = delay, bit 1 = tremolo, bit 2 = chorus
+static void set_effects(u32 value) {
+	delay_enabled = (value & 1) != 0;
+	tremolo_enabled = (value & 2) != 0;
+	chorus_enabled = (value & 4) != 0;
+}
+
+// ============================================================================
+// BENCHMARK TABLE
+// ============================================================================
+#define BENCH_MAX_SWEEP 5
+
+typedef struct {
+	const char* name;
+	int32_t (*kernel)(int32_t);     // NULL = audio_process_block() in BLOCK_SIZE chunks
+	const int32_t* input;
+	const char* param;              // swept parameter (NULL = single run)
+	void (*set)(u32 value);
+	u32 count;                      // number of sweep values (1 if param is NULL)
+	u32 values[BENCH_MAX_SWEEP];
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+	{ "baseline (loop)",     bench_baseline,       signal_table, NULL,     set_none,          1, { 0 } },
+	{ "input conditioning",  condition_input,      raw_table,    NULL,     set_none,          1, { 0 } },
+	{ "HPF+LPF cascade",     audio_filter_input,   raw_table,    "lp",     set_lp_coeff,      3, { LP_FILTER_COEFF_MIN, LP_FILTER_COEFF_DEFAULT, LP_FILTER_COEFF_MAX } },
+	{ "HPF+LPF cascade",     audio_filter_input,   raw_table,    "hp",     set_hp_coeff,      3, { HP_FILTER_COEFF_MIN, HP_FILTER_COEFF_DEFAULT, HP_FILTER_COEFF_MAX } },
+	{ "input limiter",       audio_limit_input,    signal_table, NULL,     set_none,          1, { 0 } },
+	{ "output limiter",      audio_limit_output,   signal_table, NULL,     set_none,          1, { 0 } },
+	{ "delay line write",    bench_line_write,     signal_table, NULL,     set_none,          1, { 0 } },
+	{ "delay (write+tap)",   process_delay,        signal_table, "delay",  set_delay_samples, 5, { DELAY_SAMPLES_MIN, DELAY_LINE_FAST_SIZE, DELAY_SAMPLES_DEFAULT, 32000, DELAY_SAMPLES_MAX } },
+	{ "delay (write+tap)",   process_delay,        signal_table, "fb",     set_delay_feedback, 3, { DELAY_FEEDBACK_MIN, 128, DELAY_FEEDBACK_MAX } },
+	{ "multi-tap delay",     process_delay,        signal_table, "taps",   set_delay_taps,    5, { 1, 2, 3, 4, 8 } },
+	{ "ducking delay",       process_delay,        signal_table, "duck",   set_delay_duck,    3, { DELAY_DUCK_MIN, 128, DELAY_DUCK_MAX } },
+	{ "tape delay",          process_delay,        signal_table, "delay",  set_tape_delay,    3, { DELAY_SAMPLES_MIN, DELAY_SAMPLES_DEFAULT, DELAY_TAPE_MAX } },
+	{ "reverse delay",       process_delay,        signal_table, "chunk",  set_reverse_chunk, 3, { DELAY_SAMPLES_MIN, DELAY_SAMPLES_DEFAULT, DELAY_REVERSE_CHUNK_MAX } },
+	{ "read: truncate",      bench_read_none,      signal_table, NULL,     set_none,          1, { 0 } },
+	{ "read: linear",        bench_read_linear,    signal_table, NULL,     set_none,          1, { 0 } },
+	{ "read: allpass",       bench_read_allpass,   signal_table, NULL,     set_none,          1, { 0 } },
+	{ "read: hermite",       bench_read_hermite,   signal_table, NULL,     set_none,          1, { 0 } },
+	{ "LFO bank (all)",      bench_lfo_bank,       signal_table, "wave",   set_lfo_waveform,  4, { LFO_SINE, LFO_TRIANGLE, LFO_SQUARE, LFO_RANDOM } },
+	{ "tremolo",             process_tremolo,      signal_table, "rate",   set_tremolo_rate,  3, { TREMOLO_RATE_MIN, TREMOLO_RATE_DEFAULT, TREMOLO_RATE_MAX } },
+	{ "chorus (write+tap)",  bench_chorus,         signal_table, "depth",  set_chorus_depth,  3, { CHORUS_DEPTH_MIN, CHORUS_DEPTH_DEFAULT, CHORUS_DEPTH_MAX } },
+	{ "chorus (write+tap)",  bench_chorus,         signal_table, "delay",  set_chorus_delay,  3, { CHORUS_DELAY_MIN, 8000, CHORUS_DELAY_MAX } },
+	{ "chorus (write+tap)",  bench_chorus,         signal_table, "voices", set_chorus_voices, 4, { 1, 2, 3, 4 } },
+	{ "flanger",             bench_chorus,         signal_table, "fb",     set_flanger_feedback, 3, { 0, FLANGER_FEEDBACK_DEFAULT, FLANGER_FEEDBACK_MAX } },
+	{ "vibrato",             bench_chorus,         signal_table, "depth",  set_vibrato_depth, 3, { VIBRATO_DEPTH_MIN, VIBRATO_DEPTH_DEFAULT, VIBRATO_DEPTH_MAX } },
+	{ "chain per sample",    audio_process_sample, raw_table,    "fx",     set_effects,       5, { 0, 1, 2, 4, 7 } },
+	{ "chain per block",     NULL,                 raw_table,    "fx",     set_effects,       2, { 0, 7 } },
+};
+
+#define BENCH_CASE_COUNT (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+// ============================================================================
+// RUNNERS
+// ============================================================================
+static bench_ticks_t bench_kernel(int32_t (*kernel)(int32_t), const int32_t* input) {
+	int32_t acc = 0;
+
+	// warm-up pass: caches, and on the host the branch predictor
+	for (u32 i = 0; i < BENCH_TABLE_SIZE; i++) {
+		acc += kernel(input[i]);
+	}
+
+	bench_ticks_t start = bench_now();
+	for (u32 i = 0; i < BENCH_SAMPLES; i++) {
+		acc += kernel(input[i & BENCH_TABLE_MASK]);
+	}
+	bench_ticks_t elapsed = bench_now() - start;
+
+	bench_sink = acc;
+	return elapsed;
+}
+
+static bench_ticks_t bench_block(const int32_t* input) {
+	int32_t block[BLOCK_SIZE];
+	int32_t acc = 0;
+
+	bench_ticks_t start = bench_now();
+	for (u32 i = 0; i < BENCH_SAMPLES; i += BLOCK_SIZE) {
+		for (u32 j = 0; j < BLOCK_SIZE; j++) {
+			block[j] = input[(i + j) & BENCH_TABLE_MASK];
+		}
+		audio_process_block(block, BLOCK_SIZE);
+		acc += block[0];
+	}
+	bench_ticks_t elapsed = bench_now() - start;
+
+	bench_sink = acc;
+	return elapsed;
+}
+
+static void bench_report(const bench_case_t* bench, u32 value, bench_ticks_t elapsed) {
+	u64 ticks = elapsed ? (u64) elapsed : 1;
+	u32 per_sample_x100 = (u32) ((ticks * 100) / BENCH_SAMPLES);
+	u64 samples_per_sec = ((u64) BENCH_SAMPLES * BENCH_TICK_HZ) / ticks;
+	if (samples_per_sec > 0xFFFFFFFFu) samples_per_sec = 0xFFFFFFFFu;
+
+	xil_printf("%-20s ", bench->name);
+	if (bench->param) {
+		xil_printf("%-6s%6lu ", bench->param, value);
+	}
+	else {
+		xil_printf("%12s ", "");
+	}
+	xil_printf("%7lu.%02lu %10lu %7lux\r\n",
+			   per_sample_x100 / 100, per_sample_x100 % 100,
+			   (u32) samples_per_sec, (u32) (samples_per_sec / BENCH_SAMPLE_RATE));
+}
+
+// ============================================================================
+// ENTRY POINT
+// ============================================================================
+void bench_run(void) {
+#ifdef __MICROBLAZE__
+	// sampling_ISR() would steal cycles from every row and shares the chain state
+	microblaze_disable_interrupts();
+#endif
+
+	init_tables();
+	init_audio_chain();
+	init_delay();
+	init_tremolo();
+	init_chorus();
+
+	// fill the whole lines so every tap reads real history
+	for (u32 i = 0; i < DELAY_LINE_SIZE; i++) {
+		delay_line_write(&input_line, signal_table[i & BENCH_TABLE_MASK]);
+		feed_delay(signal_table[i & BENCH_TABLE_MASK]);
+	}
+
+	xil_printf("Benchmark: %lu samples/row, INPUT_AVERAGE_LENGTH=%lu DELAY_LINE_POW2=%lu DELAY_LINE_FORMAT=%lu BLOCK_SIZE=%lu CHORUS_INTERPOLATION=%lu\r\n",
+			   (u32) BENCH_SAMPLES, (u32) INPUT_AVERAGE_LENGTH, (u32) DELAY_LINE_POW2, (u32) DELAY_LINE_FORMAT, (u32) BLOCK_SIZE,
+			   (u32) CHORUS_INTERPOLATION);
+	xil_printf("%-20s %-12s %10s %10s %8s\r\n", "kernel", "param", BENCH_UNIT "/smp", "samples/s", "realtime");
+
+	for (u32 c = 0; c < BENCH_CASE_COUNT; c++) {
+		const bench_case_t* bench = &bench_cases[c];
+		for (u32 v = 0; v < bench->count; v++) {
+			bench->set(bench->values[v]);
+			param_smooth_snap(); // kernels called directly never tick the smoothing
+			bench_ticks_t elapsed = bench->kernel ? bench_kernel(bench->kernel, bench->input) : bench_block(bench->input);
+			bench_report(bench, bench->values[v], elapsed);
+		}
+		// back to defaults so one sweep doesn't leak into the next row
+		init_delay();
+		init_tremolo();
+		init_chorus();
+		set_lfo_waveform(LFO_SINE);
+		hp_filter_coeff = HP_FILTER_COEFF_DEFAULT;
+		lp_filter_coeff = LP_FILTER_COEFF_DEFAULT;
+	}
+
+	init_audio_chain();
+	init_delay();
+	init_tremolo();
+	init_chorus();
+
+#ifdef __MICROBLAZE__
+	microblaze_enable_interrupts();
+#endif
+}
+
+#endif // BENCHMARK
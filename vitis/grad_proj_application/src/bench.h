@@ -0,0 +1,41 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "xil_types.h"
+
+// ============================================================================
+// KERNEL BENCHMARK CONFIGURATION
+// ============================================================================
+// bench_run() times every stage of the audio chain on its own (filters, limiters,
+// delay, tremolo, chorus) and the whole chain, over BENCH_SAMPLES samples per row,
+// with sweeps of the parameters that change the memory access pattern or the math.
+//
+// The same source builds in two places:
+//   MicroBlaze: BENCHMARK = 1 in the application; main() runs the suite once after
+//               BSP_init() with interrupts off. Timed with the free-running cycle
+//               counter (cycle_timer.h), reported in cycles/sample.
+//   host:       'make bench' in host/, timed with CLOCK_MONOTONIC, reported in ns/sample.
+// Delay line layout is compile-time (DELAY_LINE_POW2, DELAY_LINE_FORMAT); build once per
+// layout to compare them ('make bench' on the host runs the pow2 and modulo builds).
+
+#ifndef BENCHMARK
+#define BENCHMARK 0 // 1 = run bench_run() at startup
+#endif
+
+#ifndef BENCH_SAMPLES
+#ifdef __MICROBLAZE__
+#define BENCH_SAMPLES (1u << 16) // ~1.3 s of audio; a full-chain row takes ~1 s at 100 MHz
+#else
+#define BENCH_SAMPLES (1u << 22)
+#endif
+#endif
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+
+// Run every benchmark and print one row per kernel/parameter over UART (stdout on the host)
+// Leaves the audio chain and effects in their init_*() state
+void bench_run(void);
+
+#endif // BENCH_H
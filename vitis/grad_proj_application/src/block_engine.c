@@ -0,0 +1,72 @@
+#include "block_engine.h"
+#include "audio_chain.h"
+#include "console.h"
+#include "mem_placement.h"
+#include "isr_profile.h"
+
+// ============================================================================
+// BLOCK ENGINE STATE VARIABLES
+// ============================================================================
+
+static volatile int32_t block_in_storage[BLOCK_RING_SIZE] FAST_DATA;
+static volatile int32_t block_out_storage[BLOCK_RING_SIZE] FAST_DATA;
+static int32_t block_work[BLOCK_SIZE] FAST_DATA; // only touched by the main loop
+
+sample_ring_t block_in_ring FAST_DATA;
+sample_ring_t block_out_ring FAST_DATA;
+volatile u32 block_underruns = 0;
+volatile u32 block_overruns = 0;
+volatile u32 blocks_processed = 0;
+
+// ============================================================================
+// BLOCK PROCESSING
+// ============================================================================
+FAST_CODE int block_engine_service(void) {
+	if (sample_ring_count(&block_in_ring) < BLOCK_SIZE) {
+		return 0;
+	}
+
+	for (u32 i = 0; i < BLOCK_SIZE; i++) {
+		sample_ring_pop(&block_in_ring, &block_work[i]);
+	}
+
+	PROF_SPAN_START(block_start);
+	audio_process_block(block_work, BLOCK_SIZE);
+	PROF_SPAN_END(PROF_BLOCK, block_start); // includes any sampling_ISR() that fired meanwhile
+
+	for (u32 i = 0; i < BLOCK_SIZE; i++) {
+		sample_ring_push(&block_out_ring, block_work[i]);
+	}
+
+	blocks_processed++;
+	return 1;
+}
+
+u32 block_engine_latency_samples(void) {
+	// one block to fill the input ring + one primed block waiting in the output ring
+	return 2 * BLOCK_SIZE;
+}
+
+void block_engine_report(void) {
+	u32 latency = block_engine_latency_samples();
+	console_printf("Block engine: %lu samples/block, latency %lu samples (~%lu us)\r\n",
+			   (u32) BLOCK_SIZE, latency, (latency * 1000000) / BLOCK_SAMPLE_RATE);
+	console_printf("Block engine: %lu blocks, %lu underruns, %lu overruns\r\n",
+			   blocks_processed, block_underruns, block_overruns);
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+void init_block_engine(void) {
+	sample_ring_init(&block_in_ring, block_in_storage, BLOCK_RING_SIZE);
+	sample_ring_init(&block_out_ring, block_out_storage, BLOCK_RING_SIZE);
+	block_underruns = 0;
+	block_overruns = 0;
+	blocks_processed = 0;
+
+	// prime with one block of silence so the ISR has something to play while the first block fills
+	for (u32 i = 0; i < BLOCK_SIZE; i++) {
+		sample_ring_push(&block_out_ring, 0);
+	}
+}
@@ -0,0 +1,84 @@
+#ifndef BLOCK_ENGINE_H
+#define BLOCK_ENGINE_H
+
+#include <stdint.h>
+#include "xil_types.h"
+#include "sample_ring.h"
+#include "mem_placement.h"
+
+// ============================================================================
+// BLOCK ENGINE CONFIGURATION
+// ============================================================================
+// With BLOCK_PROCESSING = 1, sampling_ISR() only pushes the raw mic sample into
+// block_in_ring and pops a finished sample from block_out_ring. The main() idle
+// loop calls block_engine_service(), which runs the audio chain over BLOCK_SIZE
+// samples at a time.
+//
+// Trade-off: ISR time drops to a ring push/pop, but the output is delayed by
+// one block being collected plus one block of priming in the output ring:
+//   latency = 2 * BLOCK_SIZE samples (16 -> ~0.66 ms, 32 -> ~1.3 ms, 64 -> ~2.6 ms)
+
+#ifndef BLOCK_PROCESSING
+#define BLOCK_PROCESSING 0 // 0 = whole chain runs in sampling_ISR(), 1 = block engine
+#endif
+
+#ifndef BLOCK_SIZE
+#define BLOCK_SIZE 32 // samples per block: 16, 32 or 64
+#endif
+
+#if (BLOCK_SIZE != 16) && (BLOCK_SIZE != 32) && (BLOCK_SIZE != 64)
+#error "BLOCK_SIZE must be 16, 32 or 64"
+#endif
+
+// Ring size (must be power of 2); room for the block being filled, the block being
+// processed and the primed output block
+#define BLOCK_RING_SIZE (BLOCK_SIZE * 4)
+
+#define BLOCK_SAMPLE_RATE 48828 // match system sample rate
+
+// ============================================================================
+// BLOCK ENGINE STATE VARIABLES
+// ============================================================================
+
+extern sample_ring_t block_in_ring;     // raw mic samples, sampling_ISR -> main loop
+extern sample_ring_t block_out_ring;    // finished samples, main loop -> sampling_ISR
+extern volatile u32 block_underruns;    // ISR found no finished sample (main loop fell behind)
+extern volatile u32 block_overruns;     // ISR found the input ring full (main loop fell behind)
+extern volatile u32 blocks_processed;
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+
+// ISR side: queue one raw mic sample for the next block
+static inline FAST_CODE void block_engine_push_input(int32_t raw_sample) {
+	if (!sample_ring_push(&block_in_ring, raw_sample)) {
+		block_overruns++;
+	}
+}
+
+// ISR side: get the next finished sample
+// Holds the previous output on underrun so a late block doesn't produce a click to 0
+static inline FAST_CODE int32_t block_engine_pop_output(void) {
+	static int32_t last_output FAST_DATA = 0;
+	if (!sample_ring_pop(&block_out_ring, &last_output)) {
+		block_underruns++;
+	}
+	return last_output;
+}
+
+// Main loop side: process one block if a full one is waiting
+// Returns: 1 if a block was processed, 0 otherwise
+int block_engine_service(void);
+
+// Total input-to-output latency added by block processing (samples)
+u32 block_engine_latency_samples(void);
+
+// Queue block size, latency and under/overrun counters on the console (console.h;
+// a blocking print here would cause the under/overruns it counts)
+void block_engine_report(void);
+
+// Initialize rings and prime the output ring with silence
+void init_block_engine(void);
+
+#endif // BLOCK_ENGINE_H
@@ -4,30 +4,23 @@
 #include "xil_printf.h"
 #include "tremolo.h"
 #include "chorus.h"
+#include "isr_profile.h"
+#include "cycle_timer.h"
+#include "mem_placement.h"
+#include "event_log.h"
+#include "console.h"
+#include "tap_tempo.h"
+#include "looper.h"
+#include "lfo.h"
 
 XIntc sys_intc;
 XGpio enc;
 XGpio pushBtn;
 XTmrCtr sampling_tmr; // axi_timer_0
-XTmrCtr pwm_tmr; // axi_timer_1
-
-// variables for circular buffer
-volatile u32 circular_buffer[BUFFER_SIZE] = {0};
-volatile u32 write_head = 0;
-volatile u32 samples_written = 0;
-
-// variables used in sampling_ISR() for printing statistics and collecting the DC offset of the raw data
-volatile u32 sys_tick_counter = 0;
-volatile int32_t curr_sample = 0;
-volatile int32_t tiny_buffer[SAMPLES] = {0,0,0,0,0};
-static int tiny_buffer_index = 0;
-static int32_t dc_bias_drift = 0;
-static int32_t dc_bias_static = 0;
-static int first_run = 1; // just a simple flag
-static int32_t hp_filter_state = 0;
-static int32_t lp_filter_state = 0;
-static int32_t lp_filter_state_2 = 0;
-static int32_t lp_filter_state_3 = 0;
+XTmrCtr pwm_tmr[AUDIO_CHANNELS]; // axi_timer_1 (channel 0), axi_timer_2 (channel 1)
+
+// variables used in sampling_ISR() for printing statistics
+volatile u32 sys_tick_counter FAST_DATA = 0;
 
 // encoder variables
 volatile u32 btn_prev_press_time = 0;
@@ -36,138 +29,78 @@ static unsigned int enc_prev_press = 0;
 // hpf/lpf variables
 volatile u8 adjusting_lp_filter = 0;
 volatile u8 adjusting_hp_filter = 0;
-volatile u16 lp_filter_coeff = LP_FILTER_COEFF_DEFAULT;
-volatile u16 hp_filter_coeff = HP_FILTER_COEFF_DEFAULT;
 
 void BSP_init() {
 	// interrupt controller
 	XIntc_Initialize(&sys_intc, XPAR_MICROBLAZE_0_AXI_INTC_DEVICE_ID);
 	XIntc_Start(&sys_intc, XIN_REAL_MODE);
 
+	init_isr_profile();
+	init_console();
+	init_event_log();
 	init_btn_gpio();
 	init_enc_gpio();
 	init_pwm_timer();
-	init_sampling_timer();
-
+	init_audio_chain();
+	// the effects reset lines, LFOs and envelopes sampling_ISR works on, so they go
+	// after init_audio_chain() (which sets up the LFO bank) and before the timer starts
 	init_delay();
 	init_tremolo();
 	init_chorus();
+	init_tap_tempo();
+#if BLOCK_PROCESSING
+	init_block_engine(); // rings must be ready before the sampling timer starts firing
+#endif
+	init_sampling_timer();
 }
 
 // samples are grabbed from the streamer at 48828.125 Hz, so need to modify this sampling ISR to grab data at the same frequency
 // grab more than 1 sample in each ISR, for example grab 5 at a time and print out the sample index to ensure that we aren't skipping samples
 // currently, there's a fundamental mismatch between our sampling ISR (44.1 kHz) and the stream grabber (48.828125 kHz)
-void sampling_ISR() {
+FAST_CODE SAMPLING_ISR_ATTR void sampling_ISR() {
+	PROF_ISR_ENTRY(); // first, so it only counts the path into this function
+	PROF_ISR_START();
 	sys_tick_counter++;
 
 	// BASEADDR + 4 is the offset of where you "select" which index to read from the stream grabber
 	// BASEADDR + 8 is the offset of where you actually read the raw data of the mic
 	Xil_Out32(XPAR_MIC_BLOCK_STREAM_GRABBER_0_BASEADDR + 4, 0);
 	int32_t new_sample = (int32_t) Xil_In32(XPAR_MIC_BLOCK_STREAM_GRABBER_0_BASEADDR + 8);
-
-	// tiny_buffer holds the most recent 5 samples, which is used to calculate a rolling average
-	tiny_buffer[tiny_buffer_index] = new_sample;
-	tiny_buffer_index = (tiny_buffer_index + 1) % 5;
-
-    // set first sample from mic as the dc_bias
-    if (first_run) {
-		for(int i=0; i<5; i++) tiny_buffer[i] = new_sample;
-        dc_bias_static = new_sample;
-		dc_bias_drift = new_sample;
-		curr_sample = new_sample; 
-        first_run = 0;
-    }
-	else {
-		// calculate average immediately
-		int32_t sum = 0;
-		for (int i = 0; i < 5; i++) {
-			sum += tiny_buffer[i];
-		}
-		// Update global variable with the SMOOTHED value
-		curr_sample = sum / 5;
+	PROF_MARK(PROF_INPUT_FETCH);
+
+	int32_t frame[AUDIO_CHANNELS];
+#if BLOCK_PROCESSING
+	// the main loop runs the chain over whole blocks; the ISR only moves samples in and out
+	block_engine_push_input(new_sample);
+	frame[0] = block_engine_pop_output();
+#elif AUDIO_CHANNELS > 1
+	audio_process_frame(new_sample, frame);
+#else
+	frame[0] = audio_process_sample(new_sample);
+#endif
+
+	for (u32 ch = 0; ch < AUDIO_CHANNELS; ch++) {
+	    // re-center for PWM (unsigned output between 0 to 2048)
+	    // we add the mid-point of the PWM ticks (2048/2 = 1024) to turn the signed AC wave into a positive DC wave
+	    int32_t pwm_sample = frame[ch] + (RESET_VALUE / 2);
+
+	    // clip the audio for safety
+	    if (pwm_sample < 0) pwm_sample = 0;
+	    if (pwm_sample > RESET_VALUE) pwm_sample = RESET_VALUE;
+
+		// set the duty cycle of the PWM signal
+		// (direct register write: same as XTmrCtr_SetResetValue() without calling into driver code in DDR)
+	    XTmrCtr_WriteReg(pwm_tmr[ch].BaseAddress, 1, XTC_TLR_OFFSET, pwm_sample);
 	}
 
-    // moving average of the dc_bias to track it
-    dc_bias_drift += (curr_sample - dc_bias_drift) >> 10;
-    if ((dc_bias_drift > curr_sample + 1000000) || (dc_bias_drift < curr_sample - 1000000)) {
-    	dc_bias_drift = dc_bias_static;
-    }
-
-    // remove the DC offset from the current sample
-    int32_t audio_signal = curr_sample - dc_bias_drift;
-
-    // HIGH-PASS FILTER (removes low-frequency rumble)
-    hp_filter_state = hp_filter_state + ((audio_signal - hp_filter_state) * hp_filter_coeff >> 8);
-	// HPF = original signal - LPF; hp_filter_state is the LPF and subtracting it from 'audio_signal' returns the actual HPF signal
-    int32_t filtered_signal = audio_signal - hp_filter_state;
-
-    // two cascaded LPF filter (which forms a 2nd order filter) to remove high frequency squeals
-    lp_filter_state = lp_filter_state + ((filtered_signal - lp_filter_state) * lp_filter_coeff >> 8);
-    lp_filter_state_2 = lp_filter_state_2 + ((lp_filter_state - lp_filter_state_2) * lp_filter_coeff >> 8);
-    lp_filter_state_3 = lp_filter_state_3 + ((lp_filter_state_2 - lp_filter_state_3) * lp_filter_coeff >> 8);
-
-    // now that we preserve the sign, we can shift safely
-	// scale the signal down to a nice number ideally between -1024 and 1024
-    // int32_t scaled_signal = audio_signal >> 16; // change num back to 15 if it sounds bad
-    int32_t scaled_signal = lp_filter_state_3 >> 16; // revert back to 17if necessary
-
-    // INPUT LIMITER (prevents clipping in processing chain)
-    // Soft limiter: compress signal above threshold, which enables "soft clipping" (sounds better than maxing out the signal)
-	// JW Note: on Wed, we should print out scaled_signal at a fast rate to see how we can set a good INPUT LIMIT THRESHOLD
-    int32_t limited_signal = scaled_signal;
-    if (limited_signal > INPUT_LIMIT_THRESHOLD) {
-        // Soft compression: threshold + (excess / 4)
-        limited_signal = INPUT_LIMIT_THRESHOLD + ((limited_signal - INPUT_LIMIT_THRESHOLD) >> 2);
-    }
-    else if (limited_signal < -INPUT_LIMIT_THRESHOLD) {
-        limited_signal = -INPUT_LIMIT_THRESHOLD + ((limited_signal + INPUT_LIMIT_THRESHOLD) >> 2);
-    }
-
-    // ************************************************************************************************
-
-    circular_buffer[write_head] = limited_signal;
-    samples_written++;
-    write_head = (write_head + 1) % BUFFER_SIZE;
-
-    int32_t mixed_signal = limited_signal;
-    if (delay_enabled && (samples_written > delay_samples)) {
-    	mixed_signal = process_delay(mixed_signal, circular_buffer, BUFFER_SIZE, write_head);
-    }
-
-    if (tremolo_enabled) {
-    	mixed_signal = process_tremolo(mixed_signal);
-    }
-
-    if (chorus_enabled && (samples_written > (chorus_delay + chorus_depth))) {
-    	mixed_signal = process_chorus(mixed_signal, circular_buffer, BUFFER_SIZE, write_head);
-    }
-
-    // OUTPUT LIMITER
-     int32_t output_signal = mixed_signal;
-     if (output_signal > OUTPUT_LIMIT_THRESHOLD) {
-     	output_signal = OUTPUT_LIMIT_THRESHOLD;
-     }
-     else if (output_signal < -OUTPUT_LIMIT_THRESHOLD) {
-     	output_signal = -OUTPUT_LIMIT_THRESHOLD;
-     }
-
-    // re-center for PWM (unsigned output between 0 to 2048)
-    // we add the mid-point of the PWM ticks (2048/2 = 1024) to turn the signed AC wave into a positive DC wave
-    int32_t pwm_sample = output_signal + (RESET_VALUE / 2);
-
-    // clip the audio for safety 
-    if (pwm_sample < 0) pwm_sample = 0;
-    if (pwm_sample > RESET_VALUE) pwm_sample = RESET_VALUE;
-
-	// set the duty cycle of the PWM signal
-    XTmrCtr_SetResetValue(&pwm_tmr, 1, pwm_sample);
-
     // need to write some value to baseaddr of stream grabber to reset it for the next sample
     Xil_Out32(XPAR_MIC_BLOCK_STREAM_GRABBER_0_BASEADDR, 0);
 
     // clear the interrupt flag to enable the interrupt to trigger again; csr = control status register
     Xuint32 csr = XTmrCtr_ReadReg(sampling_tmr.BaseAddress, 0, XTC_TCSR_OFFSET);
     XTmrCtr_WriteReg(sampling_tmr.BaseAddress, 0, XTC_TCSR_OFFSET, csr | XTC_CSR_INT_OCCURED_MASK);
+    PROF_MARK(PROF_PWM_WRITE);
+    PROF_ISR_END();
 }
 
 void init_btn_gpio() {
@@ -200,10 +133,10 @@ void pushBtn_ISR(void *CallbackRef) {
         btn_prev_press_time = btn_curr_press_time;
         delay_enabled = !delay_enabled;
         if (delay_enabled) {
-            xil_printf("Delay ON: %lu samples (~%lu ms)\r\n", delay_samples, (delay_samples * 1000) / 48000);
+            log_event(LOG_DELAY_ON, delay_samples, 0, 0);
         }
         else {
-            xil_printf("Delay OFF\r\n");
+            log_event(LOG_DELAY_OFF, 0, 0, 0);
         }
     }
 	else if ((time_between_press > DEBOUNCE_TIME) && (btn_val & BTN_MIDDLE)) {
@@ -211,20 +144,20 @@ void pushBtn_ISR(void *CallbackRef) {
 		tremolo_enabled = !tremolo_enabled;
 		if (tremolo_enabled) {
 			// update_tremolo_phase_inc(); // note jw: try removing this to see if performance is changed; no need to update tremolo phase here?
-			xil_printf("Tremolo ON: rate=%lu, depth=%lu\r\n", tremolo_rate, tremolo_depth);
+			log_event(LOG_TREMOLO_ON, tremolo_rate, tremolo_depth, 0);
 		}
 		else {
-			xil_printf("Tremolo OFF\r\n");
+			log_event(LOG_TREMOLO_OFF, 0, 0, 0);
 		}
 	}
 	else if ((time_between_press > DEBOUNCE_TIME) && (btn_val & BTN_BOTTOM)) {
 		btn_prev_press_time = btn_curr_press_time;
 		chorus_enabled = !chorus_enabled;
 		if (chorus_enabled) {
-			xil_printf("Chorus ON: rate=%lu.%lu Hz, delay=%lu, depth=%lu\r\n", chorus_rate / 10, chorus_rate % 10, chorus_delay, chorus_depth);
+			log_event(LOG_CHORUS_ON, chorus_rate, chorus_delay, chorus_depth);
 		}
 		else {
-			xil_printf("Chorus OFF\r\n");
+			log_event(LOG_CHORUS_OFF, 0, 0, 0);
 		}
 	}
     else if ((time_between_press > DEBOUNCE_TIME) && (btn_val & BTN_RIGHT)) {
@@ -232,21 +165,27 @@ void pushBtn_ISR(void *CallbackRef) {
         adjusting_lp_filter = !adjusting_lp_filter;
         if (adjusting_lp_filter) {
             adjusting_hp_filter = 0;  // Only one filter adjustment mode at a time
-            xil_printf("Adjusting LP Filter (current: %lu)\r\n", lp_filter_coeff);
+            log_event(LOG_LP_ADJUST, 1, lp_filter_coeff, 0);
         }
         else {
-            xil_printf("LP Filter adjustment OFF (coeff: %lu)\r\n", lp_filter_coeff);
+            log_event(LOG_LP_ADJUST, 0, lp_filter_coeff, 0);
         }
     }
+    else if ((time_between_press > DEBOUNCE_TIME) && (btn_val & BTN_TAP_TEMPO) && delay_enabled) {
+		// tap tempo: only the timestamp is queued; tap_tempo_service() does the math
+		btn_prev_press_time = btn_curr_press_time;
+		tap_tempo_tap(btn_curr_press_time);
+		log_event(LOG_TAP, btn_curr_press_time, 0, 0);
+    }
     else if ((time_between_press > DEBOUNCE_TIME) && (btn_val & BTN_LEFT)) {
 		btn_prev_press_time = btn_curr_press_time;
 		adjusting_hp_filter = !adjusting_hp_filter;
 		if (adjusting_hp_filter) {
 			adjusting_lp_filter = 0;  // Only one filter adjustment mode at a time
-			xil_printf("Adjusting HP Filter (current: %lu)\r\n", hp_filter_coeff);
+			log_event(LOG_HP_ADJUST, 1, hp_filter_coeff, 0);
 		}
 		else {
-			xil_printf("HP Filter adjustment OFF (coeff: %lu)\r\n", hp_filter_coeff);
+			log_event(LOG_HP_ADJUST, 0, hp_filter_coeff, 0);
 		}
     }
 
@@ -266,29 +205,143 @@ void enc_ISR(void *CallbackRef) {
 	quad_step(ab);
 
 	if (delay_enabled) {
-		/* Raise flags on completion */
-		if (s_saw_ccw) {
-			s_saw_ccw  = 0;
-			delay_samples += DELAY_ADJUST_STEP;
-			if (delay_samples > DELAY_SAMPLES_MAX) {
-				delay_samples = DELAY_SAMPLES_MAX;
+		// Mode 0: Adjust delay time
+		// Mode 1: Adjust mix (wet level)
+		// Mode 2: Adjust feedback (regeneration)
+		// Mode 3: Select multi-tap pattern
+		// Mode 4: Select tap tempo subdivision
+		// Mode 5: Select style (forward / reverse / tape; in reverse mode 0 sets the chunk length)
+		// Mode 6: Adjust ducking depth
+		// (with AUDIO_CHANNELS > 1 the button handler below skips modes 3 and 5)
+		if (delay_adjust_mode == 0) {
+			/* Raise flags on completion */
+			if (s_saw_ccw) {
+				s_saw_ccw  = 0;
+				delay_samples += DELAY_ADJUST_STEP;
+				if (delay_samples > DELAY_SAMPLES_MAX) {
+					delay_samples = DELAY_SAMPLES_MAX;
+				}
+				log_event(LOG_DELAY_SAMPLES, delay_samples, 0, 0);
 			}
-			xil_printf("Delay: %lu samples (~%lu ms)\r\n", delay_samples, (delay_samples * 1000) / 48000);
-		}
 
-		if (s_saw_cw) {
-			s_saw_cw = 0;
-			if (delay_samples > DELAY_ADJUST_STEP) {
-				delay_samples -= DELAY_ADJUST_STEP;
-			} else {
-				delay_samples = DELAY_SAMPLES_MIN;
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				if (delay_samples > DELAY_ADJUST_STEP) {
+					delay_samples -= DELAY_ADJUST_STEP;
+				} else {
+					delay_samples = DELAY_SAMPLES_MIN;
+				}
+				log_event(LOG_DELAY_SAMPLES, delay_samples, 0, 0);
+			}
+		}
+		else if (delay_adjust_mode == 1) {
+			// CCW = more wet, CW = less wet
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				if (delay_mix > DELAY_MIX_MIN + DELAY_MIX_ADJUST_STEP) {
+					delay_mix -= DELAY_MIX_ADJUST_STEP;
+				} else {
+					delay_mix = DELAY_MIX_MIN;
+				}
+				log_event(LOG_DELAY_MIX, delay_mix, 0, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				delay_mix += DELAY_MIX_ADJUST_STEP;
+				if (delay_mix > DELAY_MIX_MAX) {
+					delay_mix = DELAY_MIX_MAX;  // Clamp at max
+				}
+				log_event(LOG_DELAY_MIX, delay_mix, 1, 0);
+			}
+		}
+		else if (delay_adjust_mode == 2) {
+			// CCW = more repeats, CW = fewer repeats
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				if (delay_feedback > DELAY_FEEDBACK_MIN + DELAY_FEEDBACK_ADJUST_STEP) {
+					delay_feedback -= DELAY_FEEDBACK_ADJUST_STEP;
+				} else {
+					delay_feedback = DELAY_FEEDBACK_MIN;
+				}
+				log_event(LOG_DELAY_FEEDBACK, delay_feedback, 0, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				delay_feedback += DELAY_FEEDBACK_ADJUST_STEP;
+				if (delay_feedback > DELAY_FEEDBACK_MAX) {
+					delay_feedback = DELAY_FEEDBACK_MAX;  // Clamp at max
+				}
+				log_event(LOG_DELAY_FEEDBACK, delay_feedback, 1, 0);
+			}
+		}
+		else if (delay_adjust_mode == 3) {
+			// CCW = next pattern, CW = previous pattern (wraps around)
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				delay_pattern = (delay_pattern + DELAY_PATTERN_COUNT - 1) % DELAY_PATTERN_COUNT;
+				log_event(LOG_DELAY_PATTERN, delay_pattern, delay_patterns[delay_pattern].count, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				delay_pattern = (delay_pattern + 1) % DELAY_PATTERN_COUNT;
+				log_event(LOG_DELAY_PATTERN, delay_pattern, delay_patterns[delay_pattern].count, 0);
+			}
+		}
+		else if (delay_adjust_mode == 4) {
+			// CCW = next subdivision, CW = previous (wraps around)
+			// the main loop re-applies the tapped beat (tap_tempo_service())
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				tap_subdivision = (tap_subdivision + TAP_SUBDIVISION_COUNT - 1) % TAP_SUBDIVISION_COUNT;
+				log_event(LOG_TAP_SUBDIVISION, tap_subdivision, 0, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				tap_subdivision = (tap_subdivision + 1) % TAP_SUBDIVISION_COUNT;
+				log_event(LOG_TAP_SUBDIVISION, tap_subdivision, 0, 0);
+			}
+		}
+		else if (delay_adjust_mode == 5) {
+			// either direction steps through the styles: forward -> reverse -> tape -> forward
+			if (s_saw_cw || s_saw_ccw) {
+				s_saw_cw = 0;
+				s_saw_ccw = 0;
+				if (delay_reverse) {
+					delay_reverse = 0;
+					delay_tape = 1;
+				} else if (delay_tape) {
+					delay_tape = 0;
+				} else {
+					delay_reverse = 1;
+				}
+				log_event(LOG_DELAY_STYLE, delay_reverse, delay_samples, delay_tape);
+			}
+		}
+		else {
+			// CCW = more ducking, CW = less
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				if (delay_duck > DELAY_DUCK_MIN + DELAY_DUCK_ADJUST_STEP) {
+					delay_duck -= DELAY_DUCK_ADJUST_STEP;
+				} else {
+					delay_duck = DELAY_DUCK_MIN;
+				}
+				log_event(LOG_DELAY_DUCK, delay_duck, 0, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				delay_duck += DELAY_DUCK_ADJUST_STEP;
+				if (delay_duck > DELAY_DUCK_MAX) {
+					delay_duck = DELAY_DUCK_MAX;
+				}
+				log_event(LOG_DELAY_DUCK, delay_duck, 1, 0);
 			}
-			xil_printf("Delay: %lu samples (~%lu ms)\r\n", delay_samples, (delay_samples * 1000) / 48000);
 		}
 	}
 	else if (tremolo_enabled) {
         // Mode 0: Adjust rate (modulation speed)
         // Mode 1: Adjust depth (modulation amount)
+        // Mode 2: Select waveform
         if (tremolo_adjust_mode == 0) {
             // Adjust tremolo rate (modulation speed)
             // CCW = slower (lower rate), CW = faster (higher rate)
@@ -300,7 +353,7 @@ void enc_ISR(void *CallbackRef) {
                     tremolo_rate = TREMOLO_RATE_MIN;
                 }
                 update_tremolo_phase_inc();  // Recalculate phase increment (avoid division in ISR)
-                xil_printf("Tremolo rate: %lu.%lu Hz - Slower\r\n", tremolo_rate / 10, tremolo_rate % 10);
+                log_event(LOG_TREMOLO_RATE, tremolo_rate, 0, 0);
             }
             if (s_saw_ccw) {
                 s_saw_ccw = 0;
@@ -310,10 +363,10 @@ void enc_ISR(void *CallbackRef) {
                     tremolo_rate = TREMOLO_RATE_MAX;  // Clamp at max
                 }
                 update_tremolo_phase_inc();  // Recalculate phase increment (avoid division in ISR)
-                xil_printf("Tremolo rate: %lu.%lu Hz - Faster\r\n", tremolo_rate / 10, tremolo_rate % 10);
+                log_event(LOG_TREMOLO_RATE, tremolo_rate, 1, 0);
             }
         }
-        else {
+        else if (tremolo_adjust_mode == 1) {
             // Adjust tremolo depth (modulation amount)
             // CCW = less depth, CW = more depth
             if (s_saw_cw) {
@@ -326,7 +379,7 @@ void enc_ISR(void *CallbackRef) {
                 } else {
                     tremolo_depth = TREMOLO_DEPTH_MIN;
                 }
-                xil_printf("Tremolo depth: %lu (~%lu%%) - Less\r\n", tremolo_depth, (tremolo_depth * 100) / 256);
+                log_event(LOG_TREMOLO_DEPTH, tremolo_depth, 0, 0);
             }
             if (s_saw_ccw) {
                 s_saw_ccw = 0;
@@ -338,7 +391,22 @@ void enc_ISR(void *CallbackRef) {
                 } else {
                     tremolo_depth = TREMOLO_DEPTH_MAX;  // Clamp at max
                 }
-                xil_printf("Tremolo depth: %lu (~%lu%%) - More\r\n", tremolo_depth, (tremolo_depth * 100) / 256);
+                log_event(LOG_TREMOLO_DEPTH, tremolo_depth, 1, 0);
+            }
+        }
+        else {
+            // CCW = next waveform, CW = previous (wraps around)
+            if (s_saw_cw) {
+                s_saw_cw = 0;
+                tremolo_waveform = (tremolo_waveform + LFO_WAVEFORM_COUNT - 1) % LFO_WAVEFORM_COUNT;
+                update_tremolo_waveform();
+                log_event(LOG_TREMOLO_WAVEFORM, tremolo_waveform, 0, 0);
+            }
+            if (s_saw_ccw) {
+                s_saw_ccw = 0;
+                tremolo_waveform = (tremolo_waveform + 1) % LFO_WAVEFORM_COUNT;
+                update_tremolo_waveform();
+                log_event(LOG_TREMOLO_WAVEFORM, tremolo_waveform, 0, 0);
             }
         }
 	}
@@ -347,6 +415,11 @@ void enc_ISR(void *CallbackRef) {
 		// Mode 0: Adjust rate (modulation speed)
 		// Mode 1: Adjust delay (base delay time)
 		// Mode 2: Adjust depth (modulation amount)
+		// Mode 3: Adjust voice count
+		// Mode 4: Adjust voice spread
+		// Mode 5: Select the style (chorus, flanger, vibrato)
+		// Flanger: modes 1-3 adjust the flanger's delay, depth and feedback (mode 4 is skipped)
+		// Vibrato: mode 2 adjusts the vibrato depth (modes 1, 3 and 4 are skipped)
 		if (chorus_adjust_mode == 0) {
 			// Adjust chorus rate (modulation speed)
 			// CCW = slower (lower rate), CW = faster (higher rate)
@@ -358,7 +431,7 @@ void enc_ISR(void *CallbackRef) {
 					chorus_rate = CHORUS_RATE_MIN;
 				}
 				update_chorus_phase_inc();  // Recalculate phase increment (avoid division in ISR)
-				xil_printf("Chorus rate: %lu.%lu Hz - Slower\r\n", chorus_rate / 10, chorus_rate % 10);
+				log_event(LOG_CHORUS_RATE, chorus_rate, 0, 0);
 			}
 			if (s_saw_ccw) {
 				s_saw_ccw = 0;
@@ -368,7 +441,90 @@ void enc_ISR(void *CallbackRef) {
 					chorus_rate = CHORUS_RATE_MAX;  // Clamp at max
 				}
 				update_chorus_phase_inc();  // Recalculate phase increment (avoid division in ISR)
-				xil_printf("Chorus rate: %lu.%lu Hz - Faster\r\n", chorus_rate / 10, chorus_rate % 10);
+				log_event(LOG_CHORUS_RATE, chorus_rate, 1, 0);
+			}
+		}
+		else if (chorus_style == CHORUS_STYLE_FLANGER && chorus_adjust_mode == 1) {
+			// Adjust flanger delay (base delay time)
+			// CCW = shorter delay, CW = longer delay
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				if (flanger_delay >= FLANGER_DELAY_MIN + FLANGER_DELAY_ADJUST_STEP) {
+					flanger_delay -= FLANGER_DELAY_ADJUST_STEP;
+				} else {
+					flanger_delay = FLANGER_DELAY_MIN;
+				}
+				log_event(LOG_FLANGER_DELAY, flanger_delay, 0, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				flanger_delay += FLANGER_DELAY_ADJUST_STEP;
+				if (flanger_delay > FLANGER_DELAY_MAX) {
+					flanger_delay = FLANGER_DELAY_MAX;
+				}
+				log_event(LOG_FLANGER_DELAY, flanger_delay, 1, 0);
+			}
+		}
+		else if (chorus_style == CHORUS_STYLE_FLANGER && chorus_adjust_mode == 2) {
+			// Adjust flanger depth (modulation amount)
+			// CCW = less depth, CW = more depth
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				if (flanger_depth >= FLANGER_DEPTH_MIN + FLANGER_DEPTH_ADJUST_STEP) {
+					flanger_depth -= FLANGER_DEPTH_ADJUST_STEP;
+				} else {
+					flanger_depth = FLANGER_DEPTH_MIN;
+				}
+				log_event(LOG_FLANGER_DEPTH, flanger_depth, 0, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				flanger_depth += FLANGER_DEPTH_ADJUST_STEP;
+				if (flanger_depth > FLANGER_DEPTH_MAX) {
+					flanger_depth = FLANGER_DEPTH_MAX;
+				}
+				log_event(LOG_FLANGER_DEPTH, flanger_depth, 1, 0);
+			}
+		}
+		else if (chorus_style == CHORUS_STYLE_FLANGER && chorus_adjust_mode == 3) {
+			// Adjust flanger feedback (negative = notches, positive = peaks)
+			// CCW = less feedback, CW = more feedback
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				flanger_feedback -= FLANGER_FEEDBACK_ADJUST_STEP;
+				if (flanger_feedback < FLANGER_FEEDBACK_MIN) {
+					flanger_feedback = FLANGER_FEEDBACK_MIN;
+				}
+				log_event(LOG_FLANGER_FEEDBACK, (u32) flanger_feedback, 0, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				flanger_feedback += FLANGER_FEEDBACK_ADJUST_STEP;
+				if (flanger_feedback > FLANGER_FEEDBACK_MAX) {
+					flanger_feedback = FLANGER_FEEDBACK_MAX;
+				}
+				log_event(LOG_FLANGER_FEEDBACK, (u32) flanger_feedback, 1, 0);
+			}
+		}
+		else if (chorus_style == CHORUS_STYLE_VIBRATO && chorus_adjust_mode == 2) {
+			// Adjust vibrato depth (pitch swing; the base delay follows it)
+			// CCW = less depth, CW = more depth
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				if (vibrato_depth >= VIBRATO_DEPTH_MIN + VIBRATO_DEPTH_ADJUST_STEP) {
+					vibrato_depth -= VIBRATO_DEPTH_ADJUST_STEP;
+				} else {
+					vibrato_depth = VIBRATO_DEPTH_MIN;
+				}
+				log_event(LOG_VIBRATO_DEPTH, vibrato_depth, 0, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				vibrato_depth += VIBRATO_DEPTH_ADJUST_STEP;
+				if (vibrato_depth > VIBRATO_DEPTH_MAX) {
+					vibrato_depth = VIBRATO_DEPTH_MAX;
+				}
+				log_event(LOG_VIBRATO_DEPTH, vibrato_depth, 1, 0);
 			}
 		}
 		else if (chorus_adjust_mode == 1) {
@@ -384,8 +540,7 @@ void enc_ISR(void *CallbackRef) {
 				} else {
 					chorus_delay = CHORUS_DELAY_MIN;
 				}
-				xil_printf("Chorus delay: %lu samples (~%lu ms) - Shorter\r\n",
-						   chorus_delay, (chorus_delay * 1000) / 48000);
+				log_event(LOG_CHORUS_DELAY, chorus_delay, 0, 0);
 			}
 			if (s_saw_ccw) {
 				s_saw_ccw = 0;
@@ -397,11 +552,10 @@ void enc_ISR(void *CallbackRef) {
 				} else {
 					chorus_delay = CHORUS_DELAY_MAX;  // Clamp at max
 				}
-				xil_printf("Chorus delay: %lu samples (~%lu ms) - Longer\r\n",
-						   chorus_delay, (chorus_delay * 1000) / 48000);
+				log_event(LOG_CHORUS_DELAY, chorus_delay, 1, 0);
 			}
 		}
-		else {
+		else if (chorus_adjust_mode == 2) {
 			// Adjust chorus depth (modulation amount)
 			// CCW = less depth, CW = more depth
 			if (s_saw_cw) {
@@ -414,8 +568,7 @@ void enc_ISR(void *CallbackRef) {
 				} else {
 					chorus_depth = CHORUS_DEPTH_MIN;
 				}
-				xil_printf("Chorus depth: %lu samples (~%lu ms) - Less\r\n",
-						   chorus_depth, (chorus_depth * 1000) / 48000);
+				log_event(LOG_CHORUS_DEPTH, chorus_depth, 0, 0);
 			}
 			if (s_saw_ccw) {
 				s_saw_ccw = 0;
@@ -427,8 +580,60 @@ void enc_ISR(void *CallbackRef) {
 				} else {
 					chorus_depth = CHORUS_DEPTH_MAX;  // Clamp at max
 				}
-				xil_printf("Chorus depth: %lu samples (~%lu ms) - More\r\n",
-						   chorus_depth, (chorus_depth * 1000) / 48000);
+				log_event(LOG_CHORUS_DEPTH, chorus_depth, 1, 0);
+			}
+		}
+		else if (chorus_adjust_mode == 3) {
+			// Adjust voice count
+			// CCW = fewer voices, CW = more voices
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				if (chorus_voices > CHORUS_VOICES_MIN) {
+					chorus_voices -= 1;
+				}
+				update_chorus_spread();  // the spacing depends on the voice count
+				log_event(LOG_CHORUS_VOICES, chorus_voices, 0, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				if (chorus_voices < CHORUS_VOICES_MAX) {
+					chorus_voices += 1;
+				}
+				update_chorus_spread();
+				log_event(LOG_CHORUS_VOICES, chorus_voices, 1, 0);
+			}
+		}
+		else if (chorus_adjust_mode == 4) {
+			// Adjust voice spread (phase spacing of the voice LFOs)
+			// CCW = narrower, CW = wider
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				if (chorus_spread > CHORUS_SPREAD_MIN) {
+					chorus_spread -= CHORUS_SPREAD_ADJUST_STEP;
+				}
+				update_chorus_spread();  // Recalculate phase offsets (avoid division in ISR)
+				log_event(LOG_CHORUS_SPREAD, chorus_spread, 0, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				if (chorus_spread < CHORUS_SPREAD_MAX) {
+					chorus_spread += CHORUS_SPREAD_ADJUST_STEP;
+				}
+				update_chorus_spread();
+				log_event(LOG_CHORUS_SPREAD, chorus_spread, 1, 0);
+			}
+		}
+		else {
+			// CCW = next style, CW = previous (wraps around)
+			if (s_saw_cw) {
+				s_saw_cw = 0;
+				set_chorus_style((chorus_style + CHORUS_STYLE_COUNT - 1) % CHORUS_STYLE_COUNT);
+				log_event(LOG_CHORUS_STYLE, chorus_style, 0, 0);
+			}
+			if (s_saw_ccw) {
+				s_saw_ccw = 0;
+				set_chorus_style((chorus_style + 1) % CHORUS_STYLE_COUNT);
+				log_event(LOG_CHORUS_STYLE, chorus_style, 1, 0);
 			}
 		}
 	}
@@ -445,8 +650,7 @@ void enc_ISR(void *CallbackRef) {
 			} else {
 				hp_filter_coeff = HP_FILTER_COEFF_MIN;
 			}
-            u32 cutoff_hz = (hp_filter_coeff * 3035) / 100;  // 30.4 * coeff, scaled by 10 for integer math
-            xil_printf("HP Filter: %lu (cutoff: ~%lu Hz) - Less filtering\r\n", hp_filter_coeff, cutoff_hz);
+            log_event(LOG_HP_COEFF, hp_filter_coeff, 0, 0);
 		}
 		if (s_saw_ccw) {
 			s_saw_ccw = 0;
@@ -459,8 +663,7 @@ void enc_ISR(void *CallbackRef) {
 			else {
 				hp_filter_coeff = HP_FILTER_COEFF_MAX;
 			}
-            u32 cutoff_hz = (hp_filter_coeff * 3035) / 100;  // 30.4 * coeff, scaled by 10 for integer math
-            xil_printf("HP Filter: %lu (cutoff: ~%lu Hz) - More filtering\r\n", hp_filter_coeff, cutoff_hz);
+            log_event(LOG_HP_COEFF, hp_filter_coeff, 1, 0);
 		}
 	}
 	else if (adjusting_lp_filter) {
@@ -476,8 +679,7 @@ void enc_ISR(void *CallbackRef) {
 			} else {
 				lp_filter_coeff = LP_FILTER_COEFF_MIN;
 			}
-            u32 cutoff_hz = (lp_filter_coeff * 3035) / 100;  // 30.4 * coeff, scaled by 10 for integer math
-            xil_printf("LP Filter: %lu (cutoff: ~%lu Hz) - More filtering\r\n", lp_filter_coeff, cutoff_hz);
+            log_event(LOG_LP_COEFF, lp_filter_coeff, 0, 0);
 		}
 		if (s_saw_ccw) {
 			s_saw_ccw = 0;
@@ -489,50 +691,87 @@ void enc_ISR(void *CallbackRef) {
 			} else {
 				lp_filter_coeff = LP_FILTER_COEFF_MAX;
 			}
-            u32 cutoff_hz = (lp_filter_coeff * 3035) / 100;  // 30.4 * coeff, scaled by 10 for integer math
-            xil_printf("LP Filter: %lu (cutoff: ~%lu Hz) - Less filtering\r\n", lp_filter_coeff, cutoff_hz);
+            log_event(LOG_LP_COEFF, lp_filter_coeff, 1, 0);
 		}
 	}
 	else {
 		if (s_saw_ccw) {
 			s_saw_ccw  = 0;
-			xil_printf("CW turn\r\n");
+			log_event(LOG_ENC_TURN, 1, 0, 0);
 		}
 
 		if (s_saw_cw) {
 			s_saw_cw = 0;
-			xil_printf("CCW turn\r\n");
+			log_event(LOG_ENC_TURN, 0, 0, 0);
 		}
 	}
 
 	if (!enc_prev_press && (curr_press & ENC_BTN)) {
-		// Encoder button pressed - toggle adjustment mode if tremolo is enabled
-		if (tremolo_enabled) {
-			tremolo_adjust_mode = !tremolo_adjust_mode;  // Toggle between rate and depth
+		// Encoder button pressed - cycle the adjustment mode of the effect the encoder is driving
+		if (delay_enabled) {
+			delay_adjust_mode = (delay_adjust_mode + 1) % 7;  // Cycle through: time, mix, feedback, pattern, subdivision, style, ducking
+#if AUDIO_CHANNELS > 1
+			// the ping-pong delay (process_delay_frame()) has no tap pattern and no
+			// reverse or tape style, so those modes would do nothing
+			while (delay_adjust_mode == 3 || delay_adjust_mode == 5) {
+				delay_adjust_mode = (delay_adjust_mode + 1) % 7;
+			}
+#endif
+			if (delay_adjust_mode == 0) {
+				log_event(LOG_DELAY_MODE, 0, delay_samples, 0);
+			} else if (delay_adjust_mode == 1) {
+				log_event(LOG_DELAY_MODE, 1, delay_mix, 0);
+			} else if (delay_adjust_mode == 2) {
+				log_event(LOG_DELAY_MODE, 2, delay_feedback, 0);
+			} else if (delay_adjust_mode == 3) {
+				log_event(LOG_DELAY_MODE, 3, delay_pattern, 0);
+			} else if (delay_adjust_mode == 4) {
+				log_event(LOG_DELAY_MODE, 4, tap_subdivision, 0);
+			} else if (delay_adjust_mode == 5) {
+				log_event(LOG_DELAY_MODE, 5, delay_reverse, delay_tape);
+			} else {
+				log_event(LOG_DELAY_MODE, 6, delay_duck, 0);
+			}
+		}
+		else if (tremolo_enabled) {
+			tremolo_adjust_mode = (tremolo_adjust_mode + 1) % 3;  // Cycle through: rate, depth, waveform
 			if (tremolo_adjust_mode == 0) {
-				xil_printf("Tremolo: Adjusting RATE (current: %lu.%lu Hz)\r\n",
-						   tremolo_rate / 10, tremolo_rate % 10);
+				log_event(LOG_TREMOLO_MODE, 0, tremolo_rate, tremolo_depth);
+			}
+			else if (tremolo_adjust_mode == 1) {
+				log_event(LOG_TREMOLO_MODE, 1, tremolo_rate, tremolo_depth);
 			}
 			else {
-				xil_printf("Tremolo: Adjusting DEPTH (current: %lu%%)\r\n",
-						   (tremolo_depth * 100) / 256);
+				log_event(LOG_TREMOLO_MODE, 2, tremolo_waveform, 0);
 			}
 		}
 		else if (chorus_enabled) {
-			chorus_adjust_mode = (chorus_adjust_mode + 1) % 3;  // Cycle through: rate, delay, depth
+			// Cycle through: rate, delay, depth, voices, spread, style, skipping what the style doesn't use
+			// (flanger: single voice, no spread; vibrato: rate and depth only)
+			u8 style = chorus_style;
+			do {
+				chorus_adjust_mode = (chorus_adjust_mode + 1) % 6;
+			} while ((style == CHORUS_STYLE_FLANGER && chorus_adjust_mode == 4) ||
+					 (style == CHORUS_STYLE_VIBRATO && (chorus_adjust_mode == 1 || chorus_adjust_mode == 3 || chorus_adjust_mode == 4)));
+
+			u32 value = 0;
 			if (chorus_adjust_mode == 0) {
-				xil_printf("Chorus: Adjusting RATE (current: %lu.%lu Hz)\r\n",
-						   chorus_rate / 10, chorus_rate % 10);
+				value = chorus_rate;
 			} else if (chorus_adjust_mode == 1) {
-				xil_printf("Chorus: Adjusting DELAY (current: %lu samples, ~%lu ms)\r\n",
-						   chorus_delay, (chorus_delay * 1000) / 48000);
-			} else {
-				xil_printf("Chorus: Adjusting DEPTH (current: %lu samples, ~%lu ms)\r\n",
-							chorus_depth, (chorus_depth * 1000) / 48000);
+				value = (style == CHORUS_STYLE_FLANGER) ? flanger_delay : chorus_delay;
+			} else if (chorus_adjust_mode == 2) {
+				value = (style == CHORUS_STYLE_FLANGER) ? flanger_depth : (style == CHORUS_STYLE_VIBRATO) ? vibrato_depth : chorus_depth;
+			} else if (chorus_adjust_mode == 3) {
+				value = (style == CHORUS_STYLE_FLANGER) ? (u32) flanger_feedback : chorus_voices;
+			} else if (chorus_adjust_mode == 4) {
+				value = chorus_spread;
 			}
+			log_event(LOG_CHORUS_MODE, chorus_adjust_mode, value, style);
 		}
 		else {
-			xil_printf("enc btn press\r\n");
+			// no effect owns the encoder: the button drives the looper (see looper.h)
+			looper_press(sys_tick_counter);
+			log_event(LOG_ENC_PRESS, 0, 0, 0);
 		}
 	}
 
@@ -544,8 +783,14 @@ void enc_ISR(void *CallbackRef) {
 int init_sampling_timer() {
 	XStatus Status;
 	Status = XST_SUCCESS;
+#if SAMPLING_FAST_INTERRUPT
+	// vectored straight to sampling_ISR(), bypassing XIntc_DeviceInterruptHandler()
+	Status = XIntc_ConnectFastHandler(&sys_intc, XPAR_MICROBLAZE_0_AXI_INTC_AXI_TIMER_0_INTERRUPT_INTR,
+			(XFastInterruptHandler) sampling_ISR);
+#else
 	Status = XIntc_Connect(&sys_intc, XPAR_MICROBLAZE_0_AXI_INTC_AXI_TIMER_0_INTERRUPT_INTR,
 			(XInterruptHandler) sampling_ISR, &sampling_tmr);
+#endif
 	if (Status != XST_SUCCESS) {
 		xil_printf("Failed to connect the application handlers to the interrupt controller...\r\n");
 		return XST_FAILURE;
@@ -566,6 +811,9 @@ int init_sampling_timer() {
 		return XST_FAILURE;
 	}
 	xil_printf("Initialized Timer!\r\n");
+
+	// counter 1 of the same timer is the free-running cycle counter used for profiling
+	init_cycle_timer();
 	/*
 	 * Enable the interrupt of the timer counter so interrupts will occur
 	 * and use auto reload mode such that the timer counter will reload
@@ -589,6 +837,7 @@ int init_sampling_timer() {
 	/*
 	 * Register the intc device driver’s handler with the Standalone
 	 * software platform’s interrupt table
+	 * (still needed in fast interrupt mode: buttons and encoder are dispatched through it)
 	 */
 	microblaze_register_handler(
 			(XInterruptHandler) XIntc_DeviceInterruptHandler,
@@ -603,38 +852,50 @@ int init_sampling_timer() {
 	return XST_SUCCESS;
 }
 
+void init_cycle_timer(void) {
+	XTmrCtr_SetOptions(&sampling_tmr, CYCLE_TIMER_COUNTER, XTC_AUTO_RELOAD_OPTION);
+	XTmrCtr_SetResetValue(&sampling_tmr, CYCLE_TIMER_COUNTER, 0);
+	XTmrCtr_Start(&sampling_tmr, CYCLE_TIMER_COUNTER);
+}
+
 int init_pwm_timer() {
 	XStatus Status;
+	const u16 device_ids[AUDIO_CHANNELS] = PWM_TIMER_DEVICE_IDS;
 
-	// Initialize the PWM Timer instance
-	Status = XTmrCtr_Initialize(&pwm_tmr, XPAR_AXI_TIMER_1_DEVICE_ID);
-	if (Status != XST_SUCCESS) {
-		return XST_FAILURE;
-	}
+	// one timer per output channel, all set up the same way
+	for (u32 ch = 0; ch < AUDIO_CHANNELS; ch++) {
+		XTmrCtr* tmr = &pwm_tmr[ch];
 
-	// Configure the timer for PWM Mode
-	// Generate Output, and Down Counting (easier for duty cycle)
-	XTmrCtr_SetOptions(&pwm_tmr, 0, XTC_EXT_COMPARE_OPTION | XTC_DOWN_COUNT_OPTION | XTC_AUTO_RELOAD_OPTION);
-	XTmrCtr_SetOptions(&pwm_tmr, 1, XTC_EXT_COMPARE_OPTION | XTC_DOWN_COUNT_OPTION | XTC_AUTO_RELOAD_OPTION);
+		// Initialize the PWM Timer instance
+		Status = XTmrCtr_Initialize(tmr, device_ids[ch]);
+		if (Status != XST_SUCCESS) {
+			return XST_FAILURE;
+		}
 
-	// Set the Period (Frequency) in the first register (TLR0)
-	// We match the sampling frequency: 2048 ticks
-	// Side Note: we can decrease 2048 to a smaller number to increase the amount of 'pwm cycles' in one sampling cycle; this leads to a smoother signal because of analog filtering
-	// think of channel 0 of the pwm_tmr as modifying the "Auto Reload Register (ARR)" of STM32 timers
-	XTmrCtr_SetResetValue(&pwm_tmr, 0, RESET_VALUE); //
+		// Configure the timer for PWM Mode
+		// Generate Output, and Down Counting (easier for duty cycle)
+		XTmrCtr_SetOptions(tmr, 0, XTC_EXT_COMPARE_OPTION | XTC_DOWN_COUNT_OPTION | XTC_AUTO_RELOAD_OPTION);
+		XTmrCtr_SetOptions(tmr, 1, XTC_EXT_COMPARE_OPTION | XTC_DOWN_COUNT_OPTION | XTC_AUTO_RELOAD_OPTION);
 
-	// Set the Duty Cycle (High Time) in the second register (TLR1)
-	// Start with 50% duty cycle (silence)
-	// think of channel 1 of the pwm_tmr as modifying the "Capture Compare Register (CCR)" of STM32 timers
-	XTmrCtr_SetResetValue(&pwm_tmr, 1, RESET_VALUE / 2); //
+		// Set the Period (Frequency) in the first register (TLR0)
+		// We match the sampling frequency: 2048 ticks
+		// Side Note: we can decrease 2048 to a smaller number to increase the amount of 'pwm cycles' in one sampling cycle; this leads to a smoother signal because of analog filtering
+		// think of channel 0 of the pwm_tmr as modifying the "Auto Reload Register (ARR)" of STM32 timers
+		XTmrCtr_SetResetValue(tmr, 0, RESET_VALUE); //
 
-	// This function sets the specific bits in the Control Status Register to turn on PWM
-	XTmrCtr_PwmEnable(&pwm_tmr);
+		// Set the Duty Cycle (High Time) in the second register (TLR1)
+		// Start with 50% duty cycle (silence)
+		// think of channel 1 of the pwm_tmr as modifying the "Capture Compare Register (CCR)" of STM32 timers
+		XTmrCtr_SetResetValue(tmr, 1, RESET_VALUE / 2); //
 
-	// Start the PWM generation
-	XTmrCtr_Start(&pwm_tmr, 0);
+		// This function sets the specific bits in the Control Status Register to turn on PWM
+		XTmrCtr_PwmEnable(tmr);
+
+		// Start the PWM generation
+		XTmrCtr_Start(tmr, 0);
+	}
 
-	xil_printf("PWM Timer successfully initialized!\r\n");
+	xil_printf("PWM Timer successfully initialized! (%lu channel%s)\r\n", (u32) AUDIO_CHANNELS, AUDIO_CHANNELS > 1 ? "s" : "");
 
 	return XST_SUCCESS;
 }
@@ -9,32 +9,52 @@
 #include "mb_interface.h" //
 #include <xbasic_types.h> //
 #include <xio.h> // provides I/O utility macros for r/w to hardware registers
+#include "audio_chain.h"
+#include "block_engine.h"
 
 #define RESET_VALUE 2048 // modify this to change frequency of sampling_ISR()
-#define SAMPLES 5
 
-// Filter coefficient ranges (0-256 scale)
-#define HP_FILTER_COEFF_MIN  1   // less filtering (removes less low frequencies)
-#define HP_FILTER_COEFF_MAX  256  // more filtering (removes more low frequencies)
-#define HP_FILTER_COEFF_DEFAULT  10
+// Sampling timer interrupt path
+// 1: axi_timer_0 is a fast interrupt: the intc hands the MicroBlaze the address of
+//    sampling_ISR() (IVAR register), so the CPU jumps straight to it and the intc
+//    acknowledges in hardware. sampling_ISR() saves its own registers and returns with rtid.
+// 0: generic path: the CPU enters XIntc_DeviceInterruptHandler(), which reads the pending
+//    interrupts, looks the handler up in the vector table, calls sampling_ISR() and then
+//    acknowledges the intc.
+// Buttons and encoder always take the generic path. With ISR_PROFILE = 1 the "IRQ entry"
+// row is the timer-expiry-to-sampling_ISR() latency, so build once per mode to compare.
+#ifndef SAMPLING_FAST_INTERRUPT
+#define SAMPLING_FAST_INTERRUPT XPAR_MICROBLAZE_0_AXI_INTC_HAS_FAST
+#endif
 
-#define LP_FILTER_COEFF_MIN  1   // More filtering (removes more high frequencies)
-#define LP_FILTER_COEFF_MAX  256 // Less filtering (removes fewer high frequencies)
-#define LP_FILTER_COEFF_DEFAULT  90
+#if SAMPLING_FAST_INTERRUPT && !XPAR_MICROBLAZE_0_AXI_INTC_HAS_FAST
+#error "SAMPLING_FAST_INTERRUPT needs the interrupt controller built with fast interrupts"
+#endif
 
-#define FILTER_COEFF_ADJUST_STEP  2  // Step size for encoder adjustment
+#if SAMPLING_FAST_INTERRUPT
+#define SAMPLING_ISR_ATTR __attribute__((fast_interrupt))
+#else
+#define SAMPLING_ISR_ATTR
+#endif
 
-// Filter coefficients (adjustable via buttons)
-extern volatile u16 hp_filter_coeff;
-extern volatile u16 lp_filter_coeff;
+// Output channels (AUDIO_CHANNELS, see audio_chain.h): one PWM timer per channel
+// channel 0 is axi_timer_1; a stereo build needs a second PWM timer, axi_timer_2
+#if AUDIO_CHANNELS > 1
+#ifndef XPAR_AXI_TIMER_2_DEVICE_ID
+#error "AUDIO_CHANNELS = 2 needs a second PWM timer (axi_timer_2) in the hardware design"
+#endif
+#if BLOCK_PROCESSING
+#error "AUDIO_CHANNELS = 2 is per-sample only (the block engine rings carry mono samples)"
+#endif
+#define PWM_TIMER_DEVICE_IDS { XPAR_AXI_TIMER_1_DEVICE_ID, XPAR_AXI_TIMER_2_DEVICE_ID }
+#else
+#define PWM_TIMER_DEVICE_IDS { XPAR_AXI_TIMER_1_DEVICE_ID }
+#endif
 
 // Filter adjustment mode flags
 extern volatile u8 adjusting_hp_filter;
 extern volatile u8 adjusting_lp_filter;
 
-#define INPUT_LIMIT_THRESHOLD 400
-#define OUTPUT_LIMIT_THRESHOLD 400
-
 // defines for 5 pushbuttons
 #define BTN_MIDDLE  BTN4_MASK
 #define BTN_RIGHT   BTN2_MASK
@@ -48,6 +68,10 @@ extern volatile u8 adjusting_lp_filter;
 #define BTN4_MASK   0x10  // bit 4 --> (BTNC on fpga board)
 #define DEBOUNCE_TIME 8000 // button presses only registered every ~0.5 sec
 
+// While the delay is on this button taps the tempo (see tap_tempo.h); the HP
+// filter adjustment it normally toggles is reachable with the delay off
+#define BTN_TAP_TEMPO BTN_LEFT
+
 // defines for encoders
 #define ENC_A       0x01
 #define ENC_B       0x02
@@ -56,9 +80,6 @@ extern volatile u8 adjusting_lp_filter;
 // =====================================================
 // logging variables (declared as extern)
 extern volatile u32 sys_tick_counter;
-extern volatile int32_t curr_sample;
-
-extern volatile int32_t tiny_buffer[SAMPLES];
 
 void BSP_init();
 
@@ -70,9 +91,9 @@ void enc_ISR(void *CallbackRef);
 
 // axi_timer_0
 int init_sampling_timer();
-void sampling_ISR();
+void sampling_ISR() SAMPLING_ISR_ATTR;
 
-// axi_timer_1
+// axi_timer_1 (and axi_timer_2 for the second channel)
 int init_pwm_timer();
 
 #endif
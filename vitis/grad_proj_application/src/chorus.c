@@ -1,111 +1,293 @@
 #include "chorus.h"
-#include "tremolo.h"  // For shared sine_table
+#include "lfo.h"
+#include "block_engine.h"
+#include "param_smooth.h"
 #include "xil_printf.h"
+#include "mem_placement.h"
 #include <stdint.h>
 
+// One bank LFO per voice (LFO_CHORUS .. LFO_CHORUS_4) and one wet gain per voice count
+#if CHORUS_VOICES_MAX != 4
+#error "CHORUS_VOICES_MAX must match the LFO_CHORUS voices in lfo.h and chorus_wet_gain[]"
+#endif
+
+#if CHORUS_INTERPOLATION != DELAY_INTERP_NONE
+// The fractional read heads take a Q16.16 delay and need 2 samples of history on
+// the short side: the modulated delay must stay in 2..65535 samples, plus the
+// block lag, plus 2 more samples for the Hermite head
+#if CHORUS_DELAY_MIN - CHORUS_DEPTH_MAX < 2 || CHORUS_DELAY_MAX + CHORUS_DEPTH_MAX + BLOCK_SIZE + 2 > 65535 \
+	|| CHORUS_DELAY_MAX + CHORUS_DEPTH_MAX + BLOCK_SIZE + 2 > DELAY_LINE_SIZE
+#error "chorus delay/depth range doesn't fit the fractional read head"
+#endif
+#endif
+
+// The flanger and vibrato sweeps, plus the Hermite head's 2 older samples, must fit the short line
+#if FLANGER_DELAY_MAX + FLANGER_DEPTH_MAX + 2 > CHORUS_SHORT_LINE_SIZE || FLANGER_DELAY_MIN <= CHORUS_SHORT_DELAY_FLOOR \
+	|| 2 * VIBRATO_DEPTH_MAX + CHORUS_SHORT_DELAY_FLOOR + 2 > CHORUS_SHORT_LINE_SIZE \
+	|| (CHORUS_SHORT_LINE_SIZE & (CHORUS_SHORT_LINE_SIZE - 1)) != 0
+#error "flanger/vibrato range doesn't fit CHORUS_SHORT_LINE_SIZE"
+#endif
+
 // ============================================================================
 // CHORUS STATE VARIABLES
 // ============================================================================
 
-volatile u8 chorus_enabled = 0;
-volatile u32 chorus_rate = CHORUS_RATE_DEFAULT;
-volatile u32 chorus_delay = CHORUS_DELAY_DEFAULT;
-volatile u32 chorus_depth = CHORUS_DEPTH_DEFAULT;
+volatile u8 chorus_enabled FAST_DATA = 0;
+volatile u32 chorus_rate FAST_DATA = CHORUS_RATE_DEFAULT;
+volatile u32 chorus_delay FAST_DATA = CHORUS_DELAY_DEFAULT;
+volatile u32 chorus_depth FAST_DATA = CHORUS_DEPTH_DEFAULT;
+volatile u32 chorus_voices FAST_DATA = CHORUS_VOICES_DEFAULT;
+volatile u32 chorus_spread = CHORUS_SPREAD_DEFAULT;
+volatile u8 chorus_style FAST_DATA = CHORUS_STYLE_CHORUS;
+volatile u32 flanger_delay FAST_DATA = FLANGER_DELAY_DEFAULT;
+volatile u32 flanger_depth FAST_DATA = FLANGER_DEPTH_DEFAULT;
+volatile int32_t flanger_feedback FAST_DATA = FLANGER_FEEDBACK_DEFAULT;
+volatile u32 vibrato_depth FAST_DATA = VIBRATO_DEPTH_DEFAULT;
 volatile u8 chorus_adjust_mode = 0;
 
+const char* const chorus_style_names[CHORUS_STYLE_COUNT] = { "CHORUS", "FLANGER", "VIBRATO" };
+
 
 // Internal state (not exposed externally)
-static volatile uint32_t chorus_lfo_phase = 0;        // LFO phase accumulator (0 to TREMOLO_SINE_TABLE_SIZE-1)
-static volatile uint32_t chorus_phase_inc = 0;        // Phase increment per sample (fixed-point)
+#if CHORUS_INTERPOLATION == DELAY_INTERP_ALLPASS
+static int32_t chorus_allpass_state[CHORUS_VOICES_MAX] FAST_DATA;   // previous all-pass output, per voice
+#endif
+
+// Short line of the flanger and vibrato: BRAM only (written and read every sample)
+static delay_sample_t short_storage[CHORUS_SHORT_LINE_SIZE] FAST_DATA;
+static delay_line_t short_line FAST_DATA = { 0, 0, 0, short_storage, CHORUS_SHORT_LINE_SIZE };
+
+// Style the audio path is running; catches up with chorus_style at the start of
+// the next sample or block (see set_chorus_style())
+static u8 active_style FAST_DATA = CHORUS_STYLE_CHORUS;
+
+// Wet gain for the sum of 'n' voices: CHORUS_WET_MIX / n, rounded (one multiply
+// instead of a divide; n = 1 is exactly the single-voice mix)
+#define CHORUS_WET_GAIN(n) ((CHORUS_WET_MIX + (n) / 2) / (n))
+static const int32_t chorus_wet_gain[CHORUS_VOICES_MAX + 1] FAST_RODATA = {
+    0, CHORUS_WET_GAIN(1), CHORUS_WET_GAIN(2), CHORUS_WET_GAIN(3), CHORUS_WET_GAIN(4)
+};
 
 // ============================================================================
 // PHASE INCREMENT CALCULATION
 // ============================================================================
-// determines the speed of chorus modulation; chorus_phase_inc is a number within range 1-9
+// determines the speed of chorus modulation (LFO_CHORUS in the shared LFO bank)
 void update_chorus_phase_inc(void) {
-    // Calculate phase increment per sample
-    // chorus_rate is in units of 0.1 Hz (e.g., 10 = 1.0 Hz)
-    // Phase increment = (rate_hz * table_size) / sample_rate
-    //                 = (chorus_rate * 0.1 * TREMOLO_SINE_TABLE_SIZE) / CHORUS_SAMPLE_RATE
-    //                 = (chorus_rate * TREMOLO_SINE_TABLE_SIZE) / (CHORUS_SAMPLE_RATE * 10)
-    // Note: Using shared sine table from tremolo.h
-
-    // Use 64-bit math to avoid overflow, then scale by 256 for fractional precision
-    uint64_t numerator = (uint64_t)chorus_rate * TREMOLO_SINE_TABLE_SIZE * 256;
-    uint64_t denominator = (uint64_t) CHORUS_SAMPLE_RATE * 10;
-    uint64_t result = numerator / denominator;
-
-    chorus_phase_inc = (uint32_t)result;
-
-    // Ensure minimum phase increment to prevent LFO from getting stuck
-    if (chorus_phase_inc == 0 && chorus_rate > 0) {
-        chorus_phase_inc = 1;  // Minimum increment (scaled by 256)
+    // every voice runs at the same rate, so their phases stay locked
+    for (u32 voice = 0; voice < CHORUS_VOICES_MAX; voice++) {
+        lfo_set_rate((lfo_id_t) (LFO_CHORUS + voice), chorus_rate);
     }
 }
 
 // ============================================================================
-// CHORUS PROCESSING
+// VOICE SPREAD
 // ============================================================================
-int32_t process_chorus(int32_t input, volatile u32* buffer, u32 buffer_size, u32 write_head) {
-    // Update LFO phase with fractional precision
-    // chorus_phase_inc is scaled by 256, so we accumulate it
-    chorus_lfo_phase += chorus_phase_inc;
-
-    // Extract integer phase index from index ranged between 0 to 255
-    // The mask ensures we wrap at table size; for example, 256 & 255 = 0
-    // this line is the same as: phase_index = (chorus_lfo_phase / 256) % TREMOLO_SINE_TABLE_SIZE
-    // Note: Using shared sine table from tremolo.h
-    uint32_t phase_index = (chorus_lfo_phase >> 8) & (TREMOLO_SINE_TABLE_SIZE - 1);
-
-    // Reset accumulator when it exceeds one full cycle to prevent overflow
-    // One full cycle = TREMOLO_SINE_TABLE_SIZE * 256 = 65536
-    if (chorus_lfo_phase >= ((uint32_t) TREMOLO_SINE_TABLE_SIZE * 256)) {
-        // keep all values between 0 to 65535
-        chorus_lfo_phase &= 0xFFFF;
+// voice k sits k * spread% / voices of a cycle after voice 1 (2^32 = one cycle)
+void update_chorus_spread(void) {
+    u32 voices = chorus_voices;
+    for (u32 voice = 0; voice < CHORUS_VOICES_MAX; voice++) {
+        u32 offset = (u32) ((((u64) chorus_spread * voice) << 32) / (100 * voices));
+        lfo_set_phase_offset((lfo_id_t) (LFO_CHORUS + voice), offset);
     }
+}
 
-    // Look up sine value from table (0-255 range, centered at 128)
-    // sine_table represents sin(0) to sin(2π), where:
-    // - 128 = sin(0) = sin(π) = sin(2π) (zero crossings)
-    // - 255 = sin(π/2) (peak)
-    // - 1 = sin(3π/2) (trough)
-    uint32_t lfo_raw = sine_table[phase_index];
-
-    // Convert sine table value to delay modulation
+// ============================================================================
+// CHORUS PROCESSING
+// ============================================================================
+// One voice: the delayed sample at this voice's modulated delay
+// lfo: this sample's value of the voice's LFO (Q15, see lfo.h)
+static inline FAST_CODE int32_t chorus_voice(const delay_line_t* line, u32 lag, u32 voice,
+                                   int32_t lfo, u32 delay_q8, u32 depth) {
+    // Convert LFO value to delay modulation
     // We want delay to oscillate between (chorus_delay - chorus_depth) and (chorus_delay + chorus_depth)
-    // Map sine value (0-255, centered at 128) to delay offset (-chorus_depth to +chorus_depth)
-    // When sine = 128 (zero): delay_offset = 0
-    // When sine = 255 (peak): delay_offset = +chorus_depth
-    // When sine = 1 (trough): delay_offset = -chorus_depth
-
-    int32_t sine_offset = (int32_t) lfo_raw - 128;  // Range: -127 to +127
+    // Map the LFO (-1.0 to +1.0 in Q15) to delay offset (-chorus_depth to +chorus_depth)
+    // When LFO = 0: delay_offset = 0
+    // When LFO = +1.0 (peak): delay_offset = +chorus_depth
+    // When LFO = -1.0 (trough): delay_offset = -chorus_depth
 
-    // Calculate modulation: sine_offset * chorus_depth / 127
-    // Use fixed-point math: multiply first, then divide
-    int32_t delay_modulation = (sine_offset * (int32_t) chorus_depth) >> 7;
+#if CHORUS_INTERPOLATION == DELAY_INTERP_NONE
+    // Calculate modulation: lfo * chorus_depth
+    // Use fixed-point math: multiply first, then drop the 15 fraction bits
+    int32_t delay_modulation = (lfo * (int32_t) depth) >> 15;
 
-    // Calculate modulated delay
-    int32_t modulated_delay = (int32_t) chorus_delay + delay_modulation;
+    // Calculate modulated delay (whole samples of the smoothed base delay)
+    int32_t modulated_delay = (int32_t) (delay_q8 >> 8) + delay_modulation;
 
-    // Clamp delay to valid range (must be at least 1 sample, and less than buffer_size)
+    // Clamp delay to valid range (must be at least 1 sample, and less than the line size)
     if (modulated_delay < 1) modulated_delay = 1;
-    if (modulated_delay >= (int32_t) buffer_size) modulated_delay = buffer_size - 1;
+    if (modulated_delay >= (int32_t) DELAY_LINE_SIZE) modulated_delay = DELAY_LINE_SIZE - 1;
 
-    // Calculate read position in circular buffer
-    // Read from position that is 'modulated_delay' samples behind write_head
-    u32 read_head = (write_head - modulated_delay + buffer_size) % buffer_size;
+    // Get delayed sample from the line
+    // Read from position that is 'modulated_delay' samples behind the sample being processed
+    // ('lag' is how far that sample is behind the line's write_head; 0 in per-sample mode)
+    int32_t delayed_signal = delay_line_read(line, (u32) modulated_delay + lag);
+#else
+    // The bank interpolates the LFO between table entries, so the delay moves every
+    // sample instead of once per entry
+    // Modulation in Q16 samples: lfo * depth, as above, with 16 fraction bits
+    // (Q15 -> Q16 = << 1; at most 32767 * 300 * 2, far inside 32 bits)
+    int32_t delay_modulation_q16 = (lfo * (int32_t) depth) << 1;
 
-    // Get delayed sample from buffer
-    int32_t delayed_signal = (int32_t) buffer[read_head];
+    // No clamp needed: the delay/depth ranges keep the head inside 2 to 65535 samples
+    // (checked at the top of this file; the short line styles cut their depth to stay
+    // above CHORUS_SHORT_DELAY_FLOOR); unsigned wrap-around adds the signed modulation
+    // (the smoothed base delay is Q8, so it glides between samples as well)
+    u32 modulated_delay_q16 = (delay_q8 << 8) + (lag << 16) + (u32) delay_modulation_q16;
 
-    // Mix dry (current) and wet (delayed) signals
+    // Read between samples ('lag' is how far the sample being processed is behind the
+    // line's write_head; 0 in per-sample mode)
+#if CHORUS_INTERPOLATION == DELAY_INTERP_LINEAR
+    int32_t delayed_signal = delay_line_read_linear(line, modulated_delay_q16);
+#elif CHORUS_INTERPOLATION == DELAY_INTERP_ALLPASS
+    int32_t delayed_signal = delay_line_read_allpass(line, modulated_delay_q16, &chorus_allpass_state[voice]);
+#else
+    int32_t delayed_signal = delay_line_read_hermite(line, modulated_delay_q16);
+#endif
+#endif
+
+    return delayed_signal;
+}
+
+// lfo[voice]: the voice LFO values of the block, 'index' = this sample's position in them
+static inline FAST_CODE int32_t chorus_kernel(int32_t input, const delay_line_t* line, u32 lag,
+                                    const int32_t* const* lfo, u32 index, u32 voices,
+                                    u32 delay_q8, u32 depth) {
+    // Sum the voices; all of them read the same line, so this is one pass over the taps
+    int32_t wet_sum = 0;
+    for (u32 voice = 0; voice < voices; voice++) {
+        wet_sum += chorus_voice(line, lag, voice, lfo[voice][index], delay_q8, depth);
+    }
+
+    // Mix dry (current) and wet (mean of the voices) signals
     int32_t dry_mixed = (input * CHORUS_DRY_MIX) >> 8;
-    int32_t wet_mixed = (delayed_signal * CHORUS_WET_MIX) >> 8;
+    int32_t wet_mixed = (wet_sum * chorus_wet_gain[voices]) >> 8;
     int32_t output = dry_mixed + wet_mixed;
 
     return output;
 }
 
+// ============================================================================
+// SHORT LINE PROCESSING (FLANGER, VIBRATO)
+// ============================================================================
+// Voice 1 of the chorus on the short line: read the tap, then write the input plus
+// the fed-back tap. The depth is cut so the sweep stays above CHORUS_SHORT_DELAY_FLOOR.
+// feedback (signed Q8), dry and wet are constants for the vibrato, so they fold away
+static inline FAST_CODE int32_t short_kernel(int32_t input, int32_t lfo, u32 delay_q8, u32 depth,
+                                   int32_t feedback, int32_t dry, int32_t wet) {
+    u32 depth_max = (delay_q8 >> 8) - CHORUS_SHORT_DELAY_FLOOR;
+    if (depth > depth_max) depth = depth_max;
+
+    // After a switch the line still holds whatever the last style left in it (it is
+    // never bulk-cleared in the audio path), so the tap stays silent until the line
+    // has been refilled as far back as it reaches: the deepest sweep plus the
+    // interpolator's older samples (as chorus_history() gates the input line)
+    int32_t delayed_signal = 0;
+    if (short_line.samples_written > (delay_q8 >> 8) + depth + 2) {
+        delayed_signal = chorus_voice(&short_line, 0, 0, lfo, delay_q8, depth);
+    }
+    delay_line_write_short(&short_line, input + ((delayed_signal * feedback) >> 8));
+
+    // Mix dry (current) and wet (delayed) signals
+    int32_t dry_mixed = (input * dry) >> 8;
+    int32_t wet_mixed = (delayed_signal * wet) >> 8;
+    return dry_mixed + wet_mixed;
+}
+
+// Vibrato base delay: just past the deepest point of the sweep (Q8)
+static inline FAST_CODE u32 vibrato_delay_q8(u32 depth_q8) {
+    return depth_q8 + (CHORUS_SHORT_DELAY_FLOOR << 8);
+}
+
+static FAST_CODE int32_t process_short(int32_t input) {
+    int32_t lfo = lfo_tail(LFO_CHORUS, 1)[0];
+    if (active_style == CHORUS_STYLE_FLANGER) {
+        return short_kernel(input, lfo, smoothed_value_q8(SMOOTH_FLANGER_DELAY), smoothed_value(SMOOTH_FLANGER_DEPTH),
+                            flanger_feedback, CHORUS_DRY_MIX, CHORUS_WET_MIX);
+    }
+    u32 depth_q8 = smoothed_value_q8(SMOOTH_VIBRATO_DEPTH);
+    return short_kernel(input, lfo, vibrato_delay_q8(depth_q8), depth_q8 >> 8,
+                        0, VIBRATO_DRY_MIX, VIBRATO_WET_MIX);
+}
+
+static FAST_CODE void process_short_block(int32_t* samples, u32 count) {
+    // Snapshot the parameters once per block, as process_chorus_block() does
+    const int32_t* lfo = lfo_tail(LFO_CHORUS, count);
+
+    // the short line is written sample by sample (feedback), so every read is at lag 0
+    if (active_style == CHORUS_STYLE_FLANGER) {
+        u32 delay_q8 = smoothed_value_q8(SMOOTH_FLANGER_DELAY);
+        u32 depth = smoothed_value(SMOOTH_FLANGER_DEPTH);
+        int32_t feedback = flanger_feedback;
+        for (u32 i = 0; i < count; i++) {
+            samples[i] = short_kernel(samples[i], lfo[i], delay_q8, depth, feedback, CHORUS_DRY_MIX, CHORUS_WET_MIX);
+        }
+    }
+    else {
+        u32 depth_q8 = smoothed_value_q8(SMOOTH_VIBRATO_DEPTH);
+        u32 delay_q8 = vibrato_delay_q8(depth_q8);
+        for (u32 i = 0; i < count; i++) {
+            samples[i] = short_kernel(samples[i], lfo[i], delay_q8, depth_q8 >> 8, 0, VIBRATO_DRY_MIX, VIBRATO_WET_MIX);
+        }
+    }
+}
+
+// Only records the request: enc_ISR() calls this, and the short line must not be
+// touched from there. The audio path switches over itself.
+void set_chorus_style(u8 style) {
+    chorus_style = style;
+}
+
+// Bring active_style up to chorus_style. Runs in the audio path, so it only rewinds
+// the short line (short_kernel() mutes the tap until it has refilled) rather than
+// clearing it; the chorus style doesn't use the short line, so it leaves it alone.
+static inline FAST_CODE void apply_chorus_style(void) {
+    u8 style = chorus_style;
+    if (style == active_style) {
+        return;
+    }
+    if (style != CHORUS_STYLE_CHORUS) {
+        delay_line_init_short(&short_line, short_storage, CHORUS_SHORT_LINE_SIZE);
+    }
+    active_style = style;
+}
+
+FAST_CODE int32_t process_chorus(int32_t input, const delay_line_t* line) {
+    apply_chorus_style();
+    if (active_style != CHORUS_STYLE_CHORUS) {
+        return process_short(input);
+    }
+
+    const int32_t* lfo[CHORUS_VOICES_MAX];
+    u32 voices = chorus_voices;
+    for (u32 voice = 0; voice < voices; voice++) {
+        lfo[voice] = lfo_tail((lfo_id_t) (LFO_CHORUS + voice), 1);
+    }
+    return chorus_kernel(input, line, 0, lfo, 0, voices,
+                         smoothed_value_q8(SMOOTH_CHORUS_DELAY), smoothed_value(SMOOTH_CHORUS_DEPTH));
+}
+
+FAST_CODE void process_chorus_block(int32_t* samples, u32 count, const delay_line_t* line) {
+    apply_chorus_style();
+    if (active_style != CHORUS_STYLE_CHORUS) {
+        process_short_block(samples, count);
+        return;
+    }
+
+    // Snapshot the parameters once per block; enc_ISR() may change them at any time
+    const int32_t* lfo[CHORUS_VOICES_MAX];
+    u32 voices = chorus_voices;
+    for (u32 voice = 0; voice < voices; voice++) {
+        lfo[voice] = lfo_tail((lfo_id_t) (LFO_CHORUS + voice), count);
+    }
+    // delay and depth follow chorus_delay / chorus_depth (see param_smooth.h)
+    u32 delay_q8 = smoothed_value_q8(SMOOTH_CHORUS_DELAY);
+    u32 depth = smoothed_value(SMOOTH_CHORUS_DEPTH);
+
+    for (u32 i = 0; i < count; i++) {
+        samples[i] = chorus_kernel(samples[i], line, count - 1 - i, lfo, i, voices, delay_q8, depth);
+    }
+}
+
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
@@ -114,7 +296,21 @@ void init_chorus(void) {
     chorus_rate = CHORUS_RATE_DEFAULT;
     chorus_delay = CHORUS_DELAY_DEFAULT;
     chorus_depth = CHORUS_DEPTH_DEFAULT;
+    chorus_voices = CHORUS_VOICES_DEFAULT;
+    chorus_spread = CHORUS_SPREAD_DEFAULT;
+    flanger_delay = FLANGER_DELAY_DEFAULT;
+    flanger_depth = FLANGER_DEPTH_DEFAULT;
+    flanger_feedback = FLANGER_FEEDBACK_DEFAULT;
+    vibrato_depth = VIBRATO_DEPTH_DEFAULT;
+    set_chorus_style(CHORUS_STYLE_CHORUS);
+    active_style = CHORUS_STYLE_CHORUS;
     chorus_adjust_mode = 0;
-    chorus_lfo_phase = 0;
+    for (u32 voice = 0; voice < CHORUS_VOICES_MAX; voice++) {
+        lfo_reset((lfo_id_t) (LFO_CHORUS + voice));
+#if CHORUS_INTERPOLATION == DELAY_INTERP_ALLPASS
+        chorus_allpass_state[voice] = 0;
+#endif
+    }
     update_chorus_phase_inc();
+    update_chorus_spread();
 }
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include "xil_types.h"
+#include "delay_line.h"
 
 // ============================================================================
 // CHORUS EFFECT CONFIGURATION
@@ -27,12 +28,80 @@
 #define CHORUS_DELAY_ADJUST_STEP 1000
 #define CHORUS_DEPTH_ADJUST_STEP 10
 
-// Sample rate (Hz)
-#define CHORUS_SAMPLE_RATE       48828 // match system sample rate
-
-// Sine table size (must be power of 2 for efficient wrapping)
-// Note: Uses shared sine table from tremolo.h (TREMOLO_SINE_TABLE_SIZE)
-#define CHORUS_SINE_TABLE_SIZE   256   // Must match TREMOLO_SINE_TABLE_SIZE
+// Voices: every voice reads the same delay line at the same base delay, each
+// modulated by its own LFO of the bank (LFO_CHORUS + voice). The voice LFOs share
+// the rate and differ only in their phase offset, so they stay locked together.
+// chorus_spread sets how far apart they are: 100% spaces chorus_voices voices
+// evenly over one LFO cycle, 0% stacks them on voice 1. The wet signal is the
+// mean of the voices, so the level doesn't grow with the voice count.
+#define CHORUS_VOICES_MAX        4     // LFO_CHORUS .. LFO_CHORUS_4 in lfo.h
+#define CHORUS_VOICES_MIN        1     // 1 = the original single voice
+#define CHORUS_VOICES_DEFAULT    1
+
+#define CHORUS_SPREAD_MIN        0     // percent of an even spacing
+#define CHORUS_SPREAD_MAX        100
+#define CHORUS_SPREAD_DEFAULT    100
+#define CHORUS_SPREAD_ADJUST_STEP 10
+
+// Styles: the same engine (LFO_CHORUS voices and read heads) in three settings
+typedef enum {
+	CHORUS_STYLE_CHORUS = 0,    // 1-4 voices on the input line, dry + wet
+	CHORUS_STYLE_FLANGER,       // 1 voice, 0.1-10 ms delay with feedback, dry + wet
+	CHORUS_STYLE_VIBRATO,       // 1 voice, short delay, wet only (pitch wobble)
+	CHORUS_STYLE_COUNT
+} chorus_style_t;
+
+// Flanger and vibrato run voice 1 on a short line of their own instead of the
+// input line: CHORUS_SHORT_LINE_SIZE samples of BRAM only, written every sample,
+// so every read is a BRAM hit and never touches DDR.
+// The read head never sweeps below CHORUS_SHORT_DELAY_FLOOR, so it never passes
+// the sample being written (the Hermite head reads one sample newer).
+#define CHORUS_SHORT_LINE_SIZE   1024  // samples (2 KB with 16-bit samples), power of 2
+#define CHORUS_SHORT_DELAY_FLOOR 2
+
+// Flanger: the short line holds the input plus the fed-back tap, so positive
+// feedback sharpens the comb peaks and negative feedback the notches. The base
+// delay can be shorter than the depth: the sweep is then cut off at the floor.
+
+#define FLANGER_DELAY_MIN        5     // ~0.1 ms at 48.8 kHz
+#define FLANGER_DELAY_MAX        488   // ~10 ms
+#define FLANGER_DELAY_DEFAULT    98    // ~2 ms
+#define FLANGER_DELAY_ADJUST_STEP 12   // ~0.25 ms
+
+#define FLANGER_DEPTH_MIN        0
+#define FLANGER_DEPTH_MAX        244   // ~5 ms
+#define FLANGER_DEPTH_DEFAULT    72    // ~1.5 ms
+#define FLANGER_DEPTH_ADJUST_STEP 12
+
+// Feedback, signed Q8 (256 = 1.0); kept below 1.0 so the loop always decays
+#define FLANGER_FEEDBACK_MIN     -240
+#define FLANGER_FEEDBACK_MAX     240
+#define FLANGER_FEEDBACK_DEFAULT 160
+#define FLANGER_FEEDBACK_ADJUST_STEP 16
+
+// Vibrato: the short line holds the input only and the output is the tap alone
+// (no dry signal), so the delay sweep is heard as pitch: +/- 2*pi * rate * depth / fs,
+// ~3% (half a semitone) for the default depth at 5 Hz. The base delay follows the
+// depth (depth + floor), so the latency is as short as the sweep allows.
+#define VIBRATO_DEPTH_MIN        2
+#define VIBRATO_DEPTH_MAX        244   // ~5 ms
+#define VIBRATO_DEPTH_DEFAULT    48    // ~1 ms
+#define VIBRATO_DEPTH_ADJUST_STEP 6
+
+#define VIBRATO_DRY_MIX          0
+#define VIBRATO_WET_MIX          256
+
+// Read head interpolation (DELAY_INTERP_* in delay_line.h)
+// With DELAY_INTERP_NONE the modulated delay is truncated to whole samples (the
+// original behaviour); the others follow the LFO between samples and between
+// sine table entries, which removes the zipper noise of a stepping read head
+#ifndef CHORUS_INTERPOLATION
+#define CHORUS_INTERPOLATION DELAY_INTERP_LINEAR
+#endif
+
+#if CHORUS_INTERPOLATION < DELAY_INTERP_NONE || CHORUS_INTERPOLATION > DELAY_INTERP_HERMITE
+#error "CHORUS_INTERPOLATION must be one of the DELAY_INTERP_* modes"
+#endif
 
 // Dry/wet mix ratios (0-256 scale)
 #define CHORUS_DRY_MIX           128    // 75% dry signal
@@ -46,21 +115,47 @@ extern volatile u8 chorus_enabled;      // Effect enable flag
 extern volatile u32 chorus_rate;        // LFO rate (in 0.1 Hz units)
 extern volatile u32 chorus_delay;       // Base delay (samples)
 extern volatile u32 chorus_depth;       // Modulation depth (samples)
-extern volatile u8 chorus_adjust_mode;	// 0 = rate, 1 = delay, 2 = depth
+extern volatile u32 chorus_voices;      // Voices (CHORUS_VOICES_MIN to CHORUS_VOICES_MAX)
+extern volatile u32 chorus_spread;      // Phase spread of the voices (percent)
+extern volatile u8 chorus_style;        // chorus_style_t, set with set_chorus_style() (the one asked for)
+extern volatile u32 flanger_delay;      // Flanger base delay (samples)
+extern volatile u32 flanger_depth;      // Flanger modulation depth (samples)
+extern volatile int32_t flanger_feedback; // Flanger feedback (signed Q8)
+extern volatile u32 vibrato_depth;      // Vibrato modulation depth (samples)
+extern volatile u8 chorus_adjust_mode;	// 0 = rate, 1 = delay, 2 = depth, 3 = voices (flanger: feedback), 4 = spread, 5 = style
+
+extern const char* const chorus_style_names[CHORUS_STYLE_COUNT];
+
+// Returns: samples of input history the current style reads (flanger and vibrato read the short line)
+static inline u32 chorus_history(void) {
+	return (chorus_style == CHORUS_STYLE_CHORUS) ? chorus_delay + chorus_depth : 0;
+}
 
 // ============================================================================
 // FUNCTION PROTOTYPES
 // ============================================================================
 
-// Process audio sample through chorus effect
-// Requires access to delay buffer
+// Process audio sample through chorus effect (or the flanger / vibrato, see chorus_style)
+// Requires access to delay line (input must already be written to it; flanger and
+// vibrato don't read it)
 // Returns: processed audio sample
-int32_t process_chorus(int32_t input, volatile u32* buffer, u32 buffer_size, u32 write_head);
+int32_t process_chorus(int32_t input, const delay_line_t* line);
+
+// Process a block of samples through chorus effect, in place
+// The whole block must already be written to the delay line
+void process_chorus_block(int32_t* samples, u32 count, const delay_line_t* line);
 
-// Update phase increment when chorus rate changes
+// Update the LFO_CHORUS phase increment when chorus rate changes
 // Call this whenever chorus_rate is modified
 void update_chorus_phase_inc(void);
 
+// Update the voice LFO phase offsets when chorus_voices or chorus_spread changes
+void update_chorus_spread(void);
+
+// Switch the style (chorus_style_t); safe from an ISR: the audio path rewinds the
+// short line and switches at the start of its next sample or block
+void set_chorus_style(u8 style);
+
 // Initialize chorus effect
 void init_chorus(void);
 
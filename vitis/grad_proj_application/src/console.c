@@ -0,0 +1,84 @@
+#include "console.h"
+#include "xparameters.h"
+#include "xil_printf.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+#ifdef STDOUT_BASEADDRESS
+#include "xuartlite_l.h"
+#endif
+
+// ============================================================================
+// CONSOLE STATE VARIABLES
+// ============================================================================
+// Main loop only (never touched from an ISR), so no volatile or locking
+
+#ifdef STDOUT_BASEADDRESS
+static char console_tx[CONSOLE_TX_SIZE];  // the host build prints straight through, so has no queue
+#endif
+static u32 console_head = 0;        // next byte to queue
+static u32 console_tail = 0;        // next byte to send
+static u32 console_dropped = 0;     // messages that didn't fit
+static u32 dropped_reported = 0;
+
+u32 console_free(void) {
+	return CONSOLE_TX_SIZE - (console_head - console_tail);
+}
+
+// ============================================================================
+// QUEUE
+// ============================================================================
+void console_printf(const char* format, ...) {
+	char line[CONSOLE_LINE_MAX];
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+	if (length < 0) {
+		return;
+	}
+	if ((u32) length >= sizeof(line)) {
+		length = sizeof(line) - 1; // cut to what vsnprintf() stored
+	}
+
+#ifdef STDOUT_BASEADDRESS
+	if ((u32) length > console_free()) {
+		console_dropped++;
+		return;
+	}
+	for (int i = 0; i < length; i++) {
+		console_tx[(console_head + i) & (CONSOLE_TX_SIZE - 1)] = line[i];
+	}
+	console_head += length;
+#else
+	xil_printf("%s", line);
+#endif
+}
+
+// ============================================================================
+// UART SIDE
+// ============================================================================
+void console_service(void) {
+#ifdef STDOUT_BASEADDRESS
+	if (console_dropped != dropped_reported && console_free() >= CONSOLE_LINE_MAX) {
+		u32 dropped = console_dropped;
+		console_printf("[console] %lu messages dropped\r\n", dropped - dropped_reported);
+		dropped_reported = dropped;
+	}
+
+	while (console_tail != console_head && !XUartLite_IsTransmitFull(STDOUT_BASEADDRESS)) {
+		XUartLite_WriteReg(STDOUT_BASEADDRESS, XUL_TX_FIFO_OFFSET, console_tx[console_tail & (CONSOLE_TX_SIZE - 1)]);
+		console_tail++;
+	}
+#endif
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+void init_console(void) {
+	console_head = 0;
+	console_tail = 0;
+	console_dropped = 0;
+	dropped_reported = 0;
+}
@@ -0,0 +1,45 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+#include "xil_types.h"
+
+// ============================================================================
+// CONSOLE CONFIGURATION
+// ============================================================================
+// xil_printf() waits on the UART for every character (~87 us each at 115200 baud),
+// so a 50-character line keeps the main loop away for ~4 ms (~210 samples). With
+// BLOCK_PROCESSING = 1 that is longer than the block rings cover (BLOCK_RING_SIZE,
+// 128 samples at the default block size), so every message printed that way
+// causes block under/overruns.
+//
+// Main-loop code prints with console_printf() instead: the message is formatted
+// into a RAM queue, and console_service() (every pass of the main loop) only moves
+// as many bytes as the UART's 16-byte TX FIFO has room for, so a pass never waits
+// on the UART (~1.4 ms worth of FIFO per pass at most, far inside one block).
+// A message that doesn't fit the queue is dropped whole and counted.
+//
+// Without a UART (host build) console_printf() prints straight away.
+// Start-up reports and the benchmark (interrupts off) still use xil_printf().
+
+#define CONSOLE_TX_SIZE   4096 // bytes queued (power of 2), ~0.36 s of UART time
+#define CONSOLE_LINE_MAX  160  // longest console_printf() message (longer ones are cut)
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+
+// Queue one formatted message (printf format; main loop only)
+void console_printf(const char* format, ...);
+
+// Move queued bytes into the UART TX FIFO, without waiting (call every main loop pass)
+void console_service(void);
+
+// Returns: bytes free in the queue (a message of up to CONSOLE_LINE_MAX fits if
+// this is at least CONSOLE_LINE_MAX)
+u32 console_free(void);
+
+// Empty the queue
+void init_console(void);
+
+#endif // CONSOLE_H
@@ -0,0 +1,35 @@
+#ifndef CYCLE_TIMER_H
+#define CYCLE_TIMER_H
+
+#include "xil_types.h"
+#include "xparameters.h"
+#include "xtmrctr_l.h"
+#include "mem_placement.h"
+
+// ============================================================================
+// CYCLE TIMER CONFIGURATION
+// ============================================================================
+// Counter 1 of axi_timer_0 runs free (reset value 0, auto reload) next to the
+// sampling timer on counter 0. It is clocked at 100 MHz, the same as the CPU,
+// so differences between two reads are CPU cycles. Started by init_cycle_timer().
+
+#define CYCLE_TIMER_BASEADDR   XPAR_AXI_TIMER_0_BASEADDR
+#define CYCLE_TIMER_COUNTER    1
+#define CYCLE_TIMER_FREQ_HZ    XPAR_AXI_TIMER_0_CLOCK_FREQ_HZ
+
+// Current cycle count (wraps every ~43 s; unsigned subtraction handles the wrap)
+static inline FAST_CODE u32 cycle_timer_read(void) {
+	return XTmrCtr_ReadReg(CYCLE_TIMER_BASEADDR, CYCLE_TIMER_COUNTER, XTC_TCR_OFFSET);
+}
+
+// Cycles since the sampling timer (counter 0) last expired and reloaded
+// Read first thing in sampling_ISR(), this is the interrupt entry latency
+static inline FAST_CODE u32 sampling_timer_elapsed(void) {
+	u32 count = XTmrCtr_ReadReg(CYCLE_TIMER_BASEADDR, 0, XTC_TCR_OFFSET);
+	return count - XTmrCtr_ReadReg(CYCLE_TIMER_BASEADDR, 0, XTC_TLR_OFFSET);
+}
+
+// Start the free-running counter (defined in bsp.c, which owns axi_timer_0)
+void init_cycle_timer(void);
+
+#endif // CYCLE_TIMER_H
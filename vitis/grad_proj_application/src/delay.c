@@ -1,39 +1,473 @@
 #include "delay.h"
 #include "xil_printf.h"
+#include "mem_placement.h"
+#include "param_smooth.h"
+#include "envelope.h"
+#include "lfo.h"
 #include <stdint.h>
 
 // ============================================================================
 // DELAY STATE VARIABLES
 // ============================================================================
 
-volatile u8 delay_enabled = 0;
-volatile u32 delay_samples = DELAY_SAMPLES_DEFAULT;
+volatile u8 delay_enabled FAST_DATA = 0;
+volatile u32 delay_samples FAST_DATA = DELAY_SAMPLES_DEFAULT;
+volatile u32 delay_mix FAST_DATA = WET_MIX;
+volatile u32 delay_feedback FAST_DATA = DELAY_FEEDBACK_DEFAULT;
+volatile u8 delay_pattern FAST_DATA = DELAY_PATTERN_SINGLE;
+volatile u8 delay_reverse FAST_DATA = 0;
+volatile u8 delay_tape FAST_DATA = 0;
+volatile u32 delay_duck FAST_DATA = DELAY_DUCK_DEFAULT;
+volatile u8 delay_adjust_mode = 0;
+
+// Feedback line: the input plus the regenerated echo, in DDR next to the input line
+// No BRAM mirror; the delay taps are at least DELAY_SAMPLES_MIN back, so only the
+// shortest settings would ever hit it, and the 8 KB is better spent elsewhere
+// Cache-line aligned, so the reverse head's line-sized groups (see below) each map to one line
+static delay_sample_t feedback_buffer[DELAY_LINE_SIZE] __attribute__((aligned(DELAY_CACHE_LINE_BYTES))) = {0};
+static delay_line_t feedback_line FAST_DATA = { feedback_buffer, 0, 0, NULL, 0 };
+
+// ============================================================================
+// MULTI-TAP PATTERNS
+// ============================================================================
+// Offsets in 1/256 beat, sorted; the last tap is on the beat (see delay.h)
+const delay_pattern_t delay_patterns[DELAY_PATTERN_COUNT] = {
+	{ "single",        1, { { 256, 256 } } },
+	{ "dotted eighth", 2, { { 192, 256 }, { 256, 160 } } },
+	{ "triplet",       3, { { 85, 256 }, { 171, 192 }, { 256, 144 } } },
+	{ "sixteenths",    4, { { 64, 256 }, { 128, 192 }, { 192, 144 }, { 256, 108 } } },
+	{ "ramp",          8, { { 32, 256 }, { 64, 224 }, { 96, 192 }, { 128, 160 },
+	                        { 160, 128 }, { 192, 96 }, { 224, 64 }, { 256, 48 } } },
+};
+
+// The pattern scaled to delay_samples, rebuilt only when the delay or pattern changes
+static delay_tap_t active_taps[DELAY_TAPS_MAX] FAST_DATA;
+static u32 active_tap_count FAST_DATA = 0;
+static u32 active_delay FAST_DATA = 0;
+static u32 active_pattern FAST_DATA = DELAY_PATTERN_COUNT; // no table built yet
+
+static FAST_CODE void build_active_taps(u32 delay, u32 pattern) {
+	const delay_pattern_t* source = &delay_patterns[pattern < DELAY_PATTERN_COUNT ? pattern : DELAY_PATTERN_SINGLE];
+
+	// insertion sort by offset, so a pattern table typed out of order still reads in one sweep
+	u32 count = 0;
+	for (u32 k = 0; k < source->count; k++) {
+		delay_tap_t tap;
+		tap.offset = (delay * source->taps[k].offset) / DELAY_TAP_BEAT;
+		tap.gain = source->taps[k].gain;
+		if (tap.offset < 2) tap.offset = 2; // delay_kernel() reads offset - 1, which must be >= 1
+
+		u32 slot = count;
+		while (slot > 0 && active_taps[slot - 1].offset > tap.offset) {
+			active_taps[slot] = active_taps[slot - 1];
+			slot--;
+		}
+		active_taps[slot] = tap;
+		count++;
+	}
+
+	active_tap_count = count;
+	active_delay = delay;
+	active_pattern = pattern;
+}
+
+#if DELAY_TIME_SMOOTHING == DELAY_SMOOTH_CROSSFADE
+// The table before the last change, faded out over DELAY_CROSSFADE_SAMPLES
+// A change in the middle of a fade drops the older table and starts a new fade
+static delay_tap_t fade_taps[DELAY_TAPS_MAX] FAST_DATA;
+static u32 fade_tap_count FAST_DATA = 0;
+static u32 fade_remaining FAST_DATA = 0; // samples left in the fade (= weight of fade_taps)
+#endif
+
+// Returns: number of active taps, after rebuilding the table if enc_ISR() changed something
+static inline FAST_CODE u32 update_active_taps(void) {
+#if DELAY_TIME_SMOOTHING == DELAY_SMOOTH_GLIDE
+	u32 delay = smoothed_value(SMOOTH_DELAY_SAMPLES); // ramps towards delay_samples (see param_smooth.h)
+#else
+	u32 delay = delay_samples;
+#endif
+	u32 pattern = delay_pattern;
+	if (delay != active_delay || pattern != active_pattern) {
+#if DELAY_TIME_SMOOTHING == DELAY_SMOOTH_CROSSFADE
+		// nothing to fade from before the first table is built
+		if (active_pattern != DELAY_PATTERN_COUNT) {
+			for (u32 k = 0; k < active_tap_count; k++) {
+				fade_taps[k] = active_taps[k];
+			}
+			fade_tap_count = active_tap_count;
+			fade_remaining = DELAY_CROSSFADE_SAMPLES;
+		}
+#endif
+		build_active_taps(delay, pattern);
+	}
+	return active_tap_count;
+}
 
 // ============================================================================
 // DELAY PROCESSING
 // ============================================================================
-int32_t process_delay(int32_t input, volatile u32* buffer, u32 buffer_size, u32 write_head) {
-	// Calculate read_head dynamically based on current write_head and delay_samples
-	// Note: write_head points to the NEXT write position (already incremented after writing current sample)
-	// Current sample is at (write_head - 1), so we need to read from (write_head - 1 - delay_samples)
-	// This ensures 'read_head' always points to data written 'delay_samples' ago
-	// We calculate it here to avoid race conditions
-	u32 read_head = (write_head - delay_samples + buffer_size) % buffer_size;
+// Returns: the gain-weighted sum of the taps; '*last' is the last (on-beat) tap
+static inline FAST_CODE int32_t read_taps(const delay_tap_t* taps, u32 tap_count, int32_t* last) {
+	// One pass over the taps, shortest first, so the reads walk back through the line
+	// in order. The current sample isn't in the line yet, so 'offset - 1' back is the
+	// sample written 'offset' ago (for the single tap: the one the input line holds
+	// 'delay_samples' back)
+	int32_t wet_sum = 0;
+	int32_t delayed_signal = 0;
+	for (u32 k = 0; k < tap_count; k++) {
+		delayed_signal = delay_line_read(&feedback_line, taps[k].offset - 1);
+		wet_sum += delayed_signal * taps[k].gain;
+	}
+	*last = delayed_signal;
+	return wet_sum >> 8;
+}
+
+static inline FAST_CODE int32_t delay_kernel(int32_t input, u32 tap_count, int32_t wet, int32_t feedback) {
+	int32_t delayed_signal;
+	int32_t wet_signal = read_taps(active_taps, tap_count, &delayed_signal);
+
+#if DELAY_TIME_SMOOTHING == DELAY_SMOOTH_CROSSFADE
+	// After a delay or pattern change, fade from the old read heads to the new ones
+	// instead of jumping (the jump is the click); only costs extra reads during the fade
+	if (fade_remaining) {
+		int32_t old_delayed;
+		int32_t old_wet = read_taps(fade_taps, fade_tap_count, &old_delayed);
+		int32_t fade = (int32_t) fade_remaining;
+		wet_signal += ((old_wet - wet_signal) * fade) >> DELAY_CROSSFADE_SHIFT;
+		delayed_signal += ((old_delayed - delayed_signal) * fade) >> DELAY_CROSSFADE_SHIFT;
+		fade_remaining--;
+	}
+#endif
 
-	int32_t delayed_signal = (int32_t)buffer[read_head];
+	// Regeneration: the last (on-beat) tap goes back in with the new input
+	// delay_line_pack() saturates the sum to the storage range without branching
+	// (the 32-bit format needs no clamp: with feedback < 256 the sum stays bounded)
+	delay_line_write(&feedback_line, input + ((delayed_signal * feedback) >> 8));
 
 	// Mix dry (current) and wet (delayed) signals
 	int32_t dry_mixed = (input * DRY_MIX) >> 8;
-	int32_t wet_mixed = (delayed_signal * WET_MIX) >> 8;
+	int32_t wet_mixed = (wet_signal * wet) >> 8;
 	int32_t output = dry_mixed + wet_mixed;
 
 	return output;
 }
 
+// ============================================================================
+// DUCKING
+// ============================================================================
+// Follows the dry input on every processed sample, ducking or not, so turning the
+// ducking up mid-note starts from the real level
+static envelope_t duck_envelope FAST_DATA;
+
+// Returns: the wet level for this sample, lowered while the input is loud
+static inline FAST_CODE int32_t duck_wet(int32_t input, int32_t wet, int32_t duck) {
+	int32_t over = envelope_push(&duck_envelope, input) - DELAY_DUCK_THRESHOLD;
+	if (over <= 0 || duck == 0) {
+		return wet;
+	}
+	if (over > DELAY_DUCK_RANGE) over = DELAY_DUCK_RANGE;
+	int32_t reduction = (over * duck) >> DELAY_DUCK_RANGE_SHIFT;
+	return (wet * (256 - reduction)) >> 8;
+}
+
+// ============================================================================
+// REVERSE DELAY
+// ============================================================================
+// A read head that walks backward through feedback_line.data, one sample per call
+// 'group' holds the cache line 'index' is in; it is refilled only when the head
+// steps into the next (older) line, so DDR is read one whole line at a time
+typedef struct {
+	u32 index;                                  // data index of the next sample to read
+	delay_sample_t group[DELAY_REVERSE_GROUP];  // copy of the line holding 'index'
+} reverse_head_t;
+
+static reverse_head_t reverse_heads[2] FAST_DATA;   // the current chunk's head and the one fading out
+static u32 reverse_current FAST_DATA = 0;           // index into reverse_heads
+static u32 reverse_remaining FAST_DATA = 0;         // samples left in the current chunk (0 = start a new one)
+static u32 reverse_fade FAST_DATA = 0;              // samples left in the boundary crossfade (= weight of the old head)
+static u8 reverse_previous_live FAST_DATA = 0;      // 0 = the old head holds nothing (first chunk after a pause)
+
+static inline FAST_CODE void reverse_head_load(reverse_head_t* head) {
+	// the line size divides DELAY_LINE_SIZE (also the legacy 40000), so a group never wraps
+	const delay_sample_t* line = &feedback_line.data[head->index & ~(DELAY_REVERSE_GROUP - 1)];
+	for (u32 k = 0; k < DELAY_REVERSE_GROUP; k++) {
+		head->group[k] = line[k];
+	}
+}
+
+// Point the head at the newest sample in the line (the end of the chunk just recorded)
+static inline FAST_CODE void reverse_head_start(reverse_head_t* head) {
+	head->index = DELAY_LINE_WRAP(feedback_line.write_head + DELAY_LINE_SIZE - 1);
+	reverse_head_load(head);
+}
+
+static inline FAST_CODE int32_t reverse_head_read(reverse_head_t* head) {
+	u32 index = head->index;
+	int32_t sample = head->group[index & (DELAY_REVERSE_GROUP - 1)];
+	index = DELAY_LINE_WRAP(index + DELAY_LINE_SIZE - 1);
+	head->index = index;
+	if ((index & (DELAY_REVERSE_GROUP - 1)) == DELAY_REVERSE_GROUP - 1) {
+		reverse_head_load(head); // stepped back into the previous line
+	}
+	return sample;
+}
+
+// Chunk length in samples: delay_samples, limited so both heads stay inside the line
+static inline FAST_CODE u32 reverse_chunk_length(void) {
+	u32 chunk = delay_samples;
+	return (chunk > DELAY_REVERSE_CHUNK_MAX) ? DELAY_REVERSE_CHUNK_MAX : chunk;
+}
+
+static inline FAST_CODE int32_t reverse_kernel(int32_t input, u32 chunk, int32_t wet, int32_t feedback) {
+	if (reverse_remaining == 0) {
+		// chunk boundary: the current head becomes the fading one and a new head starts on
+		// the chunk just completed (a new chunk length only takes effect here, so no click)
+		reverse_current ^= 1;
+		reverse_head_start(&reverse_heads[reverse_current]);
+		reverse_remaining = chunk;
+		reverse_fade = DELAY_REVERSE_FADE_SAMPLES;
+	}
+
+	int32_t reversed = reverse_head_read(&reverse_heads[reverse_current]);
+	if (reverse_fade) {
+		int32_t old = reverse_previous_live ? reverse_head_read(&reverse_heads[reverse_current ^ 1]) : 0;
+		reversed += ((old - reversed) * (int32_t) reverse_fade) >> DELAY_REVERSE_FADE_SHIFT;
+		if (--reverse_fade == 0) {
+			reverse_previous_live = 1;
+		}
+	}
+	reverse_remaining--;
+
+	// same regeneration and mix as the forward delay
+	delay_line_write(&feedback_line, input + ((reversed * feedback) >> 8));
+
+	int32_t dry_mixed = (input * DRY_MIX) >> 8;
+	int32_t wet_mixed = (reversed * wet) >> 8;
+	return dry_mixed + wet_mixed;
+}
+
+// The reverse heads only hold valid lines while the reverse delay runs; anything else
+// that writes the line restarts it on a fresh chunk
+static inline FAST_CODE void reverse_pause(void) {
+	reverse_remaining = 0;
+	reverse_previous_live = 0;
+}
+
+// ============================================================================
+// TAPE DELAY
+// ============================================================================
+static int32_t tape_tone_state FAST_DATA = 0; // feedback low-pass output
+
+static inline FAST_CODE u32 tape_delay_q8(void) {
+	u32 delay_q8 = smoothed_value_q8(SMOOTH_DELAY_SAMPLES);
+	return (delay_q8 > (DELAY_TAPE_MAX << 8)) ? (DELAY_TAPE_MAX << 8) : delay_q8;
+}
+
+// wow, flutter: this sample's LFO_TAPE_WOW / LFO_TAPE_FLUTTER values (Q15, lfo.h)
+static inline FAST_CODE int32_t tape_kernel(int32_t input, u32 delay_q8, int32_t wet, int32_t feedback,
+                                            int32_t wow, int32_t flutter) {
+	// Q16 modulation: LFO (Q15) * depth (Q15 -> Q16 = << 1, as in the chorus)
+	int32_t modulation_q16 = (wow * DELAY_TAPE_WOW_DEPTH + flutter * DELAY_TAPE_FLUTTER_DEPTH) << 1;
+
+	// The current sample isn't in the line yet, so one sample less than the delay
+	// (delay_q8 >= DELAY_SAMPLES_MIN, so the head never gets near the write head)
+	u32 delay_q16 = (delay_q8 << 8) - DELAY_Q16_ONE + (u32) modulation_q16;
+	int32_t delayed_signal = delay_line_read_linear(&feedback_line, delay_q16);
+
+	// only the regenerated part is darkened, so the first echo keeps its top end
+	tape_tone_state += ((delayed_signal - tape_tone_state) * DELAY_TAPE_TONE) >> 8;
+	delay_line_write(&feedback_line, input + ((tape_tone_state * feedback) >> 8));
+
+	int32_t dry_mixed = (input * DRY_MIX) >> 8;
+	int32_t wet_mixed = (delayed_signal * wet) >> 8;
+	return dry_mixed + wet_mixed;
+}
+
+// ============================================================================
+// MODE DISPATCH
+// ============================================================================
+FAST_CODE int32_t process_delay(int32_t input) {
+	int32_t wet = duck_wet(input, (int32_t) delay_mix, (int32_t) delay_duck);
+	if (delay_reverse) {
+		return reverse_kernel(input, reverse_chunk_length(), wet, (int32_t) delay_feedback);
+	}
+	reverse_pause();
+	if (delay_tape) {
+		return tape_kernel(input, tape_delay_q8(), wet, (int32_t) delay_feedback,
+		                   lfo_tail(LFO_TAPE_WOW, 1)[0], lfo_tail(LFO_TAPE_FLUTTER, 1)[0]);
+	}
+	u32 tap_count = update_active_taps();
+	return delay_kernel(input, tap_count, wet, (int32_t) delay_feedback);
+}
+
+FAST_CODE void process_delay_block(int32_t* samples, u32 count) {
+	// the parameters can be changed by enc_ISR() at any time; use one value for the whole block
+	int32_t wet = (int32_t) delay_mix;
+	int32_t feedback = (int32_t) delay_feedback;
+	int32_t duck = (int32_t) delay_duck;
+
+	if (delay_reverse) {
+		u32 chunk = reverse_chunk_length();
+		for (u32 i = 0; i < count; i++) {
+			samples[i] = reverse_kernel(samples[i], chunk, duck_wet(samples[i], wet, duck), feedback);
+		}
+		return;
+	}
+
+	reverse_pause();
+
+	if (delay_tape) {
+		u32 delay_q8 = tape_delay_q8();
+		const int32_t* wow = lfo_tail(LFO_TAPE_WOW, count);
+		const int32_t* flutter = lfo_tail(LFO_TAPE_FLUTTER, count);
+		for (u32 i = 0; i < count; i++) {
+			samples[i] = tape_kernel(samples[i], delay_q8, duck_wet(samples[i], wet, duck), feedback,
+			                         wow[i], flutter[i]);
+		}
+		return;
+	}
+
+	u32 tap_count = update_active_taps();
+
+	// each sample reads its echoes and is then written, exactly as in per-sample mode
+	for (u32 i = 0; i < count; i++) {
+		samples[i] = delay_kernel(samples[i], tap_count, duck_wet(samples[i], wet, duck), feedback);
+	}
+}
+
+FAST_CODE void feed_delay(int32_t input) {
+	reverse_pause();
+	delay_line_write(&feedback_line, input);
+}
+
+FAST_CODE void feed_delay_block(const int32_t* samples, u32 count) {
+	if (count) {
+		reverse_pause(); // the block path calls this with count = 0 once the delay has warmed up
+	}
+	for (u32 i = 0; i < count; i++) {
+		delay_line_write(&feedback_line, samples[i]);
+	}
+}
+
+#if AUDIO_CHANNELS > 1
+// ============================================================================
+// PING-PONG DELAY
+// ============================================================================
+// Interleaved line: frame n holds the AUDIO_CHANNELS samples written at sample n
+static delay_sample_t pingpong_buffer[DELAY_LINE_SIZE] __attribute__((aligned(DELAY_CACHE_LINE_BYTES))) = {0};
+static u32 pingpong_head FAST_DATA = 0; // frame the NEXT sample period is written to
+
+#if DELAY_LINE_POW2
+#define PINGPONG_WRAP(frame) ((frame) & (DELAY_PINGPONG_FRAMES - 1))
+#else
+#define PINGPONG_WRAP(frame) ((frame) % DELAY_PINGPONG_FRAMES)
+#endif
+
+#if DELAY_TIME_SMOOTHING == DELAY_SMOOTH_CROSSFADE
+// The delay before the last change, faded out over DELAY_CROSSFADE_SAMPLES as the
+// mono delay fades its old taps (a change mid-fade starts a new fade)
+static u32 pingpong_delay FAST_DATA = 0;          // 0 = nothing to fade from yet
+static u32 pingpong_fade_delay FAST_DATA = 0;
+static u32 pingpong_fade_remaining FAST_DATA = 0; // samples left in the fade (= weight of the old head)
+#endif
+
+FAST_CODE void process_delay_frame(int32_t input, int32_t* frame) {
+#if DELAY_TIME_SMOOTHING == DELAY_SMOOTH_GLIDE
+	u32 delay = smoothed_value(SMOOTH_DELAY_SAMPLES);
+#else
+	u32 delay = delay_samples;
+#endif
+	if (delay < 1) delay = 1;
+	if (delay > DELAY_PINGPONG_MAX) delay = DELAY_PINGPONG_MAX;
+	int32_t wet = duck_wet(input, (int32_t) delay_mix, (int32_t) delay_duck);
+	int32_t feedback = (int32_t) delay_feedback;
+
+	const delay_sample_t* echo = &pingpong_buffer[PINGPONG_WRAP(pingpong_head + DELAY_PINGPONG_FRAMES - delay) * AUDIO_CHANNELS];
+	delay_sample_t* next = &pingpong_buffer[pingpong_head * AUDIO_CHANNELS];
+	int32_t dry_mixed = (input * DRY_MIX) >> 8;
+
+	int32_t echoes[AUDIO_CHANNELS];
+	for (u32 ch = 0; ch < AUDIO_CHANNELS; ch++) {
+		echoes[ch] = echo[ch];
+	}
+
+#if DELAY_TIME_SMOOTHING == DELAY_SMOOTH_CROSSFADE
+	// After a delay change, fade from the old frame to the new one instead of jumping
+	if (delay != pingpong_delay) {
+		if (pingpong_delay != 0) {
+			pingpong_fade_delay = pingpong_delay;
+			pingpong_fade_remaining = DELAY_CROSSFADE_SAMPLES;
+		}
+		pingpong_delay = delay;
+	}
+	if (pingpong_fade_remaining) {
+		const delay_sample_t* old_echo = &pingpong_buffer[PINGPONG_WRAP(pingpong_head + DELAY_PINGPONG_FRAMES - pingpong_fade_delay) * AUDIO_CHANNELS];
+		int32_t fade = (int32_t) pingpong_fade_remaining;
+		for (u32 ch = 0; ch < AUDIO_CHANNELS; ch++) {
+			echoes[ch] += ((old_echo[ch] - echoes[ch]) * fade) >> DELAY_CROSSFADE_SHIFT;
+		}
+		pingpong_fade_remaining--;
+	}
+#endif
+
+	// channel 0 takes the input plus the last channel's echo, every other channel the
+	// echo of the channel before it
+	int32_t passed = echoes[AUDIO_CHANNELS - 1];
+	for (u32 ch = 0; ch < AUDIO_CHANNELS; ch++) {
+		int32_t delayed_signal = echoes[ch];
+		int32_t fed = (ch == 0) ? input : 0;
+		next[ch] = delay_line_pack(fed + ((passed * feedback) >> 8));
+		frame[ch] = dry_mixed + ((delayed_signal * wet) >> 8);
+		passed = delayed_signal;
+	}
+
+	pingpong_head = PINGPONG_WRAP(pingpong_head + 1);
+}
+
+FAST_CODE void feed_delay_frame(int32_t input) {
+	delay_sample_t* next = &pingpong_buffer[pingpong_head * AUDIO_CHANNELS];
+	next[0] = delay_line_pack(input);
+	for (u32 ch = 1; ch < AUDIO_CHANNELS; ch++) {
+		next[ch] = 0;
+	}
+	pingpong_head = PINGPONG_WRAP(pingpong_head + 1);
+}
+#endif
+
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
 void init_delay(void) {
     delay_enabled = 0;
     delay_samples = DELAY_SAMPLES_DEFAULT;
+    delay_mix = WET_MIX;
+    delay_feedback = DELAY_FEEDBACK_DEFAULT;
+    delay_pattern = DELAY_PATTERN_SINGLE;
+    delay_reverse = 0;
+    delay_tape = 0;
+    delay_duck = DELAY_DUCK_DEFAULT;
+    delay_adjust_mode = 0;
+    active_pattern = DELAY_PATTERN_COUNT;
+#if DELAY_TIME_SMOOTHING == DELAY_SMOOTH_CROSSFADE
+    fade_remaining = 0;
+#endif
+    reverse_current = 0;
+    reverse_pause();
+    tape_tone_state = 0;
+    lfo_reset(LFO_TAPE_WOW);
+    lfo_reset(LFO_TAPE_FLUTTER);
+    lfo_set_rate(LFO_TAPE_WOW, DELAY_TAPE_WOW_RATE);
+    lfo_set_rate(LFO_TAPE_FLUTTER, DELAY_TAPE_FLUTTER_RATE);
+    envelope_init(&duck_envelope, DELAY_DUCK_ATTACK_SHIFT, DELAY_DUCK_RELEASE_SHIFT);
+
+    for (u32 i = 0; i < DELAY_LINE_SIZE; i++) feedback_buffer[i] = 0;
+    delay_line_init(&feedback_line, feedback_buffer, NULL);
+#if AUDIO_CHANNELS > 1
+    for (u32 i = 0; i < DELAY_LINE_SIZE; i++) pingpong_buffer[i] = 0;
+    pingpong_head = 0;
+#if DELAY_TIME_SMOOTHING == DELAY_SMOOTH_CROSSFADE
+    pingpong_delay = 0;
+    pingpong_fade_remaining = 0;
+#endif
+#endif
 }
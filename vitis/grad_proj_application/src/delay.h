@@ -3,41 +3,191 @@
 
 #include <stdint.h>
 #include "xil_types.h"
+#include "xparameters.h"
+#include "delay_line.h"
+#include "audio_chain.h"
 
 // ============================================================================
 // DELAY EFFECT CONFIGURATION
 // ============================================================================
 
-// Buffer size (shared with other effects that use delay)
-#define BUFFER_SIZE 40000 // this buffer size is statically set by the programmers; size is not dynamic
-
 // Delay range (in samples)
 #define DELAY_SAMPLES_MIN 1000
-#define DELAY_SAMPLES_MAX 38000
+#define DELAY_SAMPLES_MAX (DELAY_LINE_SIZE - 2000) // 38000 with the original 40000-sample buffer
 #define DELAY_SAMPLES_DEFAULT 8000 // this controls the default spacing between read/write head
 
 // Adjustment step size
 #define DELAY_ADJUST_STEP 1000
 
+// What a delay time (or pattern) change does to the read heads
+#define DELAY_SMOOTH_NONE      0 // jump to the new delay (clicks)
+#define DELAY_SMOOTH_CROSSFADE 1 // fade from the old heads to the new ones over DELAY_CROSSFADE_SAMPLES
+#define DELAY_SMOOTH_GLIDE     2 // slide the heads to the new delay (pitch bend, like tape; see param_smooth.h)
+
+#ifndef DELAY_TIME_SMOOTHING
+#define DELAY_TIME_SMOOTHING DELAY_SMOOTH_CROSSFADE
+#endif
+
+#define DELAY_CROSSFADE_SHIFT   9
+#define DELAY_CROSSFADE_SAMPLES (1u << DELAY_CROSSFADE_SHIFT) // ~10 ms
+
 // Dry/wet mix ratios (0-256 scale)
-#define WET_MIX 192    // 75% wet signal
+#define WET_MIX 192    // 75% wet signal (default of delay_mix)
 #define DRY_MIX 62     // 24% dry signal
 
+// Wet level range, adjustable from the encoder (0-256 scale)
+// The dry level stays at DRY_MIX so the pass-through signal doesn't jump while turning
+#define DELAY_MIX_MIN 0
+#define DELAY_MIX_MAX 256
+#define DELAY_MIX_ADJUST_STEP 16
+
+// Feedback (regeneration) range (0-256 scale): how much of each echo is written back
+// into the line. 0 is the original single echo; below 256 every repeat is quieter than
+// the last, so the loop can't run away (the line saturates the sum as a last guard)
+#define DELAY_FEEDBACK_MIN 0
+#define DELAY_FEEDBACK_MAX 240     // ~94%: each repeat ~0.6 dB below the last
+#define DELAY_FEEDBACK_DEFAULT 0
+#define DELAY_FEEDBACK_ADJUST_STEP 16
+
+// Multi-tap patterns
+// Each pattern is a table of taps at fractions of delay_samples (256 = one beat =
+// delay_samples), each with its own gain (0-256). The last tap always sits on the
+// beat and is the one fed back, so the whole pattern repeats every beat.
+// All taps are read from the feedback line in one pass, shortest offset first.
+#define DELAY_TAPS_MAX 8
+#define DELAY_TAP_BEAT 256
+
+typedef enum {
+	DELAY_PATTERN_SINGLE = 0,   // 1 tap: the original single echo
+	DELAY_PATTERN_DOTTED_EIGHTH,// 2 taps: 3/4 and 1 beat
+	DELAY_PATTERN_TRIPLET,      // 3 taps: 1/3, 2/3 and 1 beat
+	DELAY_PATTERN_SIXTEENTHS,   // 4 taps: every 1/4 beat, fading
+	DELAY_PATTERN_RAMP,         // 8 taps: every 1/8 beat, fading
+	DELAY_PATTERN_COUNT
+} delay_pattern_id_t;
+
+typedef struct {
+	u32 offset;     // in the pattern table: 1/256 beat; in the active table: samples
+	int32_t gain;   // 0-256
+} delay_tap_t;
+
+typedef struct {
+	const char* name;
+	u32 count;
+	delay_tap_t taps[DELAY_TAPS_MAX];
+} delay_pattern_t;
+
+extern const delay_pattern_t delay_patterns[DELAY_PATTERN_COUNT];
+
+// Reverse delay
+// The line is cut into chunks of delay_samples; once a chunk is complete it is
+// played backward while the next one records, so each echo comes out reversed one
+// chunk later. The reverse head walks back through the line one cache line
+// (DELAY_REVERSE_GROUP samples) at a time: the whole line is copied into the
+// head in one go and the next DELAY_REVERSE_GROUP reads come from that copy.
+// At each chunk boundary the old head keeps reading past the end of its chunk
+// while it fades out, and the new head fades in (DELAY_REVERSE_FADE_SAMPLES).
+// The pattern is ignored in reverse; mix and feedback work as in forward mode.
+#define DELAY_REVERSE_FADE_SHIFT   8
+#define DELAY_REVERSE_FADE_SAMPLES (1u << DELAY_REVERSE_FADE_SHIFT) // ~5 ms
+
+// D-cache line size in bytes (the BSP gives it in words); the host stubs have no
+// cache, so they fall back to the 16-byte line the hardware is built with
+#ifdef XPAR_MICROBLAZE_0_DCACHE_LINE_LEN
+#define DELAY_CACHE_LINE_BYTES     (XPAR_MICROBLAZE_0_DCACHE_LINE_LEN * 4)
+#else
+#define DELAY_CACHE_LINE_BYTES     16
+#endif
+#define DELAY_REVERSE_GROUP        (DELAY_CACHE_LINE_BYTES / sizeof(delay_sample_t)) // samples per D-cache line
+
+// A chunk is played back while the next one records, and the fading head reads a
+// little past its chunk, so the oldest read is 2 * (chunk + fade) samples back
+#define DELAY_REVERSE_CHUNK_MAX    ((DELAY_LINE_SIZE / 2) - DELAY_REVERSE_FADE_SAMPLES - 1)
+
+// Tape delay
+// One read head, like a tape echo: its delay drifts with a slow wow LFO and a fast
+// flutter LFO (LFO_TAPE_WOW / LFO_TAPE_FLUTTER in lfo.h), read between samples
+// with delay_line_read_linear(), and the echo goes back into the line through a
+// one-pole low-pass, so every repeat is darker than the last. The delay time
+// glides (SMOOTH_DELAY_SAMPLES) instead of crossfading, and the pattern is ignored.
+// The fractional head reaches at most 65535 samples, so with the longer lines the
+// delay is capped at DELAY_TAPE_MAX in this mode.
+#define DELAY_TAPE_WOW_RATE        8     // 0.8 Hz (0.1 Hz units, as the tremolo/chorus rates)
+#define DELAY_TAPE_WOW_DEPTH       32    // samples (~0.65 ms) each way
+#define DELAY_TAPE_FLUTTER_RATE    60    // 6.0 Hz
+#define DELAY_TAPE_FLUTTER_DEPTH   4     // samples each way
+#define DELAY_TAPE_TONE            96    // feedback low-pass coefficient (0-256, lower = darker, ~3 kHz)
+#define DELAY_TAPE_Q16_MAX         (65535 - DELAY_TAPE_WOW_DEPTH - DELAY_TAPE_FLUTTER_DEPTH - 2)
+#define DELAY_TAPE_MAX             ((DELAY_SAMPLES_MAX < DELAY_TAPE_Q16_MAX) ? DELAY_SAMPLES_MAX : DELAY_TAPE_Q16_MAX)
+
+// Ducking
+// An envelope follower (envelope.h) on the dry input lowers the wet level while
+// the input is loud, so the echoes stay out of the way of the playing and come up
+// in the gaps. Above DELAY_DUCK_THRESHOLD the wet level drops linearly, down to
+// (256 - delay_duck) / 256 of delay_mix once the envelope is DELAY_DUCK_RANGE
+// above the threshold. Works the same in every mode (taps, reverse, ping-pong);
+// only the output is ducked, the regeneration into the line is not.
+#define DELAY_DUCK_MIN            0     // off
+#define DELAY_DUCK_MAX            256   // echoes fully muted while playing loud
+#define DELAY_DUCK_DEFAULT        0
+#define DELAY_DUCK_ADJUST_STEP    32
+#define DELAY_DUCK_THRESHOLD      24    // envelope (sample units, input is +/- INPUT_LIMIT_THRESHOLD)
+#define DELAY_DUCK_RANGE_SHIFT    7
+#define DELAY_DUCK_RANGE          (1 << DELAY_DUCK_RANGE_SHIFT)
+#define DELAY_DUCK_ATTACK_SHIFT   5     // ~0.7 ms: duck at once on a pick attack
+#define DELAY_DUCK_RELEASE_SHIFT  13    // ~170 ms: let the echoes bloom back after a note
+
+// Ping-pong delay (AUDIO_CHANNELS > 1, see audio_chain.h)
+// One line holds all channels interleaved, a frame of AUDIO_CHANNELS samples per
+// sample period, so both channels of an echo sit in the same cache line. The input
+// goes into channel 0, and each channel's echo is fed back into the next channel,
+// so the repeats step L, R, L, ... delay_samples apart. Mix, feedback and delay time
+// changes (DELAY_TIME_SMOOTHING) work as in the mono delay; the tap pattern and the
+// reverse and tape styles don't apply, so the encoder skips those modes.
+#define DELAY_PINGPONG_FRAMES      (DELAY_LINE_SIZE / AUDIO_CHANNELS)
+#define DELAY_PINGPONG_MAX         (DELAY_PINGPONG_FRAMES - 1)
+
 // ============================================================================
 // DELAY STATE VARIABLES (extern for access from bsp.c)
 // ============================================================================
 
 extern volatile u8 delay_enabled;      // Effect enable flag
 extern volatile u32 delay_samples;     // Delay time (samples)
+extern volatile u32 delay_mix;         // Wet level (0-256)
+extern volatile u32 delay_feedback;    // Regeneration (0-256)
+extern volatile u8 delay_pattern;      // delay_pattern_id_t
+extern volatile u8 delay_reverse;      // 1 = reverse delay (delay_samples is the chunk length)
+extern volatile u8 delay_tape;         // 1 = tape delay (ignored while delay_reverse is set)
+extern volatile u32 delay_duck;        // Ducking depth (0-256, 0 = off)
+extern volatile u8 delay_adjust_mode;  // 0 = time, 1 = mix, 2 = feedback, 3 = pattern, 4 = tap subdivision, 5 = style, 6 = ducking
 
 // ============================================================================
 // FUNCTION PROTOTYPES
 // ============================================================================
 
-// Process audio sample through delay effect
-// Requires access to delay buffer
+// The delay keeps its own line: each sample is written AFTER the feedback sum
+// (input + feedback * echo), so the echoes regenerate. The chorus keeps reading the
+// clean input line. Every sample must go through exactly one of process_delay() or
+// feed_delay(), so the line stays in step with the input line.
+
+// Process audio sample through delay effect (forward taps, reverse or tape, see delay_reverse / delay_tape)
 // Returns: processed audio sample (dry + wet mix)
-int32_t process_delay(int32_t input, volatile u32* buffer, u32 buffer_size, u32 write_head);
+int32_t process_delay(int32_t input);
+
+// Process a block of samples through delay effect, in place
+void process_delay_block(int32_t* samples, u32 count);
+
+// Bypass: write the dry input to the delay line so it holds history when enabled
+void feed_delay(int32_t input);
+void feed_delay_block(const int32_t* samples, u32 count);
+
+#if AUDIO_CHANNELS > 1
+// Ping-pong delay: one input sample in, AUDIO_CHANNELS output samples (dry + wet) out
+void process_delay_frame(int32_t input, int32_t* frame);
+
+// Bypass: write the dry input (channel 0) so the ping-pong line holds history when enabled
+void feed_delay_frame(int32_t input);
+#endif
 
 // Initialize delay effect
 void init_delay(void);
@@ -0,0 +1,218 @@
+#ifndef DELAY_LINE_H
+#define DELAY_LINE_H
+
+#include <stdint.h>
+#include "xil_types.h"
+#include "mem_placement.h"
+
+// ============================================================================
+// DELAY LINE CONFIGURATION
+// ============================================================================
+// Circular buffer of past samples (the input line read by the chorus, and the
+// delay's own feedback line).
+//
+// DELAY_LINE_POW2 = 1: capacity is a power of 2 and every index wraps with a mask
+//                      (a single AND instead of a hardware divide on MicroBlaze)
+// DELAY_LINE_POW2 = 0: original 40000-sample buffer wrapped with '% size'
+
+#ifndef DELAY_LINE_POW2
+#define DELAY_LINE_POW2 1
+#endif
+
+// Storage format of each sample in the line
+// The input limiter keeps conditioned samples far inside +/-32767, so 16-bit storage
+// halves the DDR footprint (and the cache lines touched per tap) without losing bits
+#define DELAY_LINE_FORMAT_S32 0 // original layout: one int32 per sample
+#define DELAY_LINE_FORMAT_S16 1 // int16 per sample, saturated to +/-32767
+#define DELAY_LINE_FORMAT_S12 2 // int16 per sample, saturated to the 12-bit ADC range (+/-2047)
+
+#ifndef DELAY_LINE_FORMAT
+#define DELAY_LINE_FORMAT DELAY_LINE_FORMAT_S16
+#endif
+
+#if DELAY_LINE_FORMAT == DELAY_LINE_FORMAT_S32
+typedef int32_t delay_sample_t;
+#define DELAY_LINE_SAMPLE_MAX  INT32_MAX
+#elif DELAY_LINE_FORMAT == DELAY_LINE_FORMAT_S16
+typedef int16_t delay_sample_t;
+#define DELAY_LINE_SAMPLE_MAX  32767
+#elif DELAY_LINE_FORMAT == DELAY_LINE_FORMAT_S12
+typedef int16_t delay_sample_t;
+#define DELAY_LINE_SAMPLE_MAX  2047
+#else
+#error "unknown DELAY_LINE_FORMAT"
+#endif
+
+#if DELAY_LINE_POW2
+// 16-bit samples get twice the capacity, so the line is 256 KB in every format
+#if DELAY_LINE_FORMAT == DELAY_LINE_FORMAT_S32
+#define DELAY_LINE_SIZE_LOG2  16 // 65536 samples (~1.34 s at 48.8 kHz)
+#else
+#define DELAY_LINE_SIZE_LOG2  17 // 131072 samples (~2.68 s at 48.8 kHz)
+#endif
+#define DELAY_LINE_SIZE       (1u << DELAY_LINE_SIZE_LOG2)
+#define DELAY_LINE_MASK       (DELAY_LINE_SIZE - 1)
+#define DELAY_LINE_WRAP(index) ((index) & DELAY_LINE_MASK)
+#else
+#define DELAY_LINE_SIZE       40000u // this buffer size is statically set by the programmers; size is not dynamic
+#define DELAY_LINE_WRAP(index) ((index) % DELAY_LINE_SIZE)
+#endif
+
+// Short window of the most recent samples mirrored into LMB BRAM
+// Taps shorter than this (chorus, short delays) never touch DDR; longer taps read
+// the full line in DDR. Must be a power of 2.
+#ifndef DELAY_LINE_FAST_SIZE
+#define DELAY_LINE_FAST_SIZE  4096 // 8 KB of BRAM with 16-bit samples (~84 ms)
+#endif
+
+// A short line is only the BRAM window, with no DDR line behind it (the flanger's
+// feedback line). Its window can be any power of 2; reads must stay within it.
+
+// ============================================================================
+// DELAY LINE TYPE
+// ============================================================================
+
+typedef struct {
+	delay_sample_t* data;   // DELAY_LINE_SIZE samples (NULL for a short line)
+	u32 write_head;         // index the NEXT sample will be written to
+	u32 samples_written;    // total samples written (used to skip reads of unwritten history)
+	delay_sample_t* fast;   // optional mirror of the newest fast_size samples in BRAM (NULL if none)
+	u32 fast_size;          // DELAY_LINE_FAST_SIZE (or a short line's size) if 'fast' is set, 0 otherwise
+} delay_line_t;
+
+static inline void delay_line_init(delay_line_t* line, delay_sample_t* storage, delay_sample_t* fast_storage) {
+	line->data = storage;
+	line->write_head = 0;
+	line->samples_written = 0;
+	line->fast = fast_storage;
+	line->fast_size = fast_storage ? DELAY_LINE_FAST_SIZE : 0;
+}
+
+// 'size' samples of 'storage' (a power of 2, in BRAM) and nothing else
+static inline void delay_line_init_short(delay_line_t* line, delay_sample_t* storage, u32 size) {
+	line->data = 0;
+	line->write_head = 0;
+	line->samples_written = 0;
+	line->fast = storage;
+	line->fast_size = size;
+}
+
+// Convert a sample to the storage format (saturating for the 16-bit formats)
+// The clamp is branch-free: each arithmetic shift yields an all-ones mask only when
+// that limit is exceeded, and the mask selects the limit instead of the sample
+// (valid for |sample| < 2^31 - DELAY_LINE_SAMPLE_MAX, far beyond any real signal)
+static inline FAST_CODE delay_sample_t delay_line_pack(int32_t sample) {
+#if DELAY_LINE_FORMAT != DELAY_LINE_FORMAT_S32
+	int32_t over = (DELAY_LINE_SAMPLE_MAX - sample) >> 31;
+	sample = (sample & ~over) | (DELAY_LINE_SAMPLE_MAX & over);
+	int32_t under = (sample + DELAY_LINE_SAMPLE_MAX) >> 31;
+	sample = (sample & ~under) | (-DELAY_LINE_SAMPLE_MAX & under);
+#endif
+	return (delay_sample_t) sample;
+}
+
+// Append one sample at write_head
+// The BRAM mirror is indexed by samples_written, which wraps cleanly at any power of 2
+// even when the main line is the 40000-sample legacy buffer
+static inline FAST_CODE void delay_line_write(delay_line_t* line, int32_t sample) {
+	delay_sample_t packed = delay_line_pack(sample);
+	line->data[line->write_head] = packed;
+	if (line->fast) {
+		line->fast[line->samples_written & (line->fast_size - 1)] = packed;
+	}
+	line->write_head = DELAY_LINE_WRAP(line->write_head + 1);
+	line->samples_written++;
+}
+
+// Append one sample to a short line (delay_line_init_short())
+static inline FAST_CODE void delay_line_write_short(delay_line_t* line, int32_t sample) {
+	line->fast[line->samples_written & (line->fast_size - 1)] = delay_line_pack(sample);
+	line->samples_written++;
+}
+
+// Read the sample written 'delay' samples ago (delay = 1 is the most recent sample)
+// delay must be between 1 and DELAY_LINE_SIZE (1 and fast_size for a short line)
+static inline FAST_CODE int32_t delay_line_read(const delay_line_t* line, u32 delay) {
+	if (delay <= line->fast_size) {
+		return line->fast[(line->samples_written - delay) & (line->fast_size - 1)];
+	}
+#if DELAY_LINE_POW2
+	// unsigned wrap-around of (write_head - delay) is fixed up by the mask
+	return line->data[(line->write_head - delay) & DELAY_LINE_MASK];
+#else
+	return line->data[(line->write_head - delay + DELAY_LINE_SIZE) % DELAY_LINE_SIZE];
+#endif
+}
+
+// ============================================================================
+// FRACTIONAL READS
+// ============================================================================
+// Read heads for modulated taps (chorus). The delay is Q16.16 samples: the upper
+// 16 bits are the whole samples (same meaning as delay_line_read()), the lower 16
+// bits the fraction towards the next older sample, so fractional taps reach at most
+// 65535 samples (~1.3 s). All integer math; the products
+// are sized so nothing overflows 32 bits even for full-scale 16-bit samples.
+//
+//   DELAY_INTERP_NONE     truncate the fraction (1 read; steps in the delay -> zipper noise)
+//   DELAY_INTERP_LINEAR   2 reads, 1 multiply; slight high-frequency loss
+//   DELAY_INTERP_ALLPASS  2 reads, 1 divide; flat magnitude, but keeps state, so one
+//                         state variable per read head and the head must move slowly
+//   DELAY_INTERP_HERMITE  4 reads, 3rd-order (Catmull-Rom); best quality, most cycles
+#define DELAY_INTERP_NONE     0
+#define DELAY_INTERP_LINEAR   1
+#define DELAY_INTERP_ALLPASS  2
+#define DELAY_INTERP_HERMITE  3
+
+#define DELAY_Q16_ONE         (1u << 16)
+#define DELAY_Q16_FRAC_MASK   (DELAY_Q16_ONE - 1)
+
+// delay_q16 between 1.0 and DELAY_LINE_SIZE - 1
+static inline FAST_CODE int32_t delay_line_read_linear(const delay_line_t* line, u32 delay_q16) {
+	u32 delay = delay_q16 >> 16;
+	int32_t frac = (int32_t) ((delay_q16 & DELAY_Q16_FRAC_MASK) >> 1); // Q15, so the product fits
+	int32_t newer = delay_line_read(line, delay);
+	int32_t older = delay_line_read(line, delay + 1);
+	return newer + (((older - newer) * frac) >> 15);
+}
+
+// delay_q16 between 2.0 and DELAY_LINE_SIZE - 1
+// First-order all-pass y = a * (x0 - y_prev) + x1 with a = (1 - d) / (1 + d).
+// The fractional part d is kept in [0.5, 1.5) by borrowing a whole sample, which
+// keeps the pole well away from the unit circle. '*state' is the previous output.
+static inline FAST_CODE int32_t delay_line_read_allpass(const delay_line_t* line, u32 delay_q16, int32_t* state) {
+	u32 delay = delay_q16 >> 16;
+	int32_t frac = (int32_t) (delay_q16 & DELAY_Q16_FRAC_MASK);
+	if (frac < (int32_t) (DELAY_Q16_ONE / 2)) {
+		delay--;
+		frac += DELAY_Q16_ONE;
+	}
+	int32_t coeff = (((int32_t) DELAY_Q16_ONE - frac) << 15) / ((int32_t) DELAY_Q16_ONE + frac); // Q15, -0.2..0.33
+
+	int32_t newer = delay_line_read(line, delay);
+	int32_t older = delay_line_read(line, delay + 1);
+	int32_t output = older + ((coeff * (newer - *state)) >> 15);
+	*state = output;
+	return output;
+}
+
+// delay_q16 between 2.0 and DELAY_LINE_SIZE - 2
+// The polynomial is evaluated with doubled coefficients and a Q11 fraction: the
+// Horner steps then stay below 2^31 for full-scale 16-bit samples
+static inline FAST_CODE int32_t delay_line_read_hermite(const delay_line_t* line, u32 delay_q16) {
+	u32 delay = delay_q16 >> 16;
+	int32_t frac = (int32_t) ((delay_q16 & DELAY_Q16_FRAC_MASK) >> 5); // Q11
+	int32_t xm1 = delay_line_read(line, delay - 1);
+	int32_t x0 = delay_line_read(line, delay);
+	int32_t x1 = delay_line_read(line, delay + 1);
+	int32_t x2 = delay_line_read(line, delay + 2);
+
+	int32_t c1 = x1 - xm1;
+	int32_t c2 = 2 * xm1 - 5 * x0 + 4 * x1 - x2;
+	int32_t c3 = (x2 - xm1) + 3 * (x0 - x1);
+	int32_t acc = ((c3 * frac) >> 11) + c2;
+	acc = ((acc * frac) >> 11) + c1;
+	acc = (acc * frac) >> 11;
+	return x0 + (acc >> 1);
+}
+
+#endif // DELAY_LINE_H
@@ -0,0 +1,54 @@
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <stdint.h>
+#include "xil_types.h"
+#include "mem_placement.h"
+
+// ============================================================================
+// ENVELOPE FOLLOWER
+// ============================================================================
+// Peak follower: rectify, then a one-pole that rises with the attack time and
+// falls with the release time. Both coefficients are 1/2^shift, so each push is
+// an abs, a subtract, a compare and a shift (no multiply); the time constant is
+// about 2^shift samples (shift 5 = ~0.7 ms, shift 13 = ~170 ms at 48.8 kHz).
+//
+// The level keeps ENVELOPE_FRAC_BITS below the sample LSB, so the long release
+// shifts still move at the low levels this chain runs at (+/- 400).
+// |sample| must stay below 2^(31 - ENVELOPE_FRAC_BITS).
+//
+// Each user keeps its own envelope_t, so the delay (ducking), the limiter or the
+// tremolo can each follow a different signal with different times.
+//
+// Peak only: a mean-square (RMS) follower would need a square root before its
+// level can be compared with sample values, which costs more than the whole push.
+
+#define ENVELOPE_FRAC_BITS 12
+
+typedef struct {
+	int32_t level;      // Q(ENVELOPE_FRAC_BITS)
+	u32 attack_shift;
+	u32 release_shift;
+} envelope_t;
+
+static inline void envelope_init(envelope_t* envelope, u32 attack_shift, u32 release_shift) {
+	envelope->level = 0;
+	envelope->attack_shift = attack_shift;
+	envelope->release_shift = release_shift;
+}
+
+// Add one sample
+// Returns: the envelope in sample units
+static inline FAST_CODE int32_t envelope_push(envelope_t* envelope, int32_t sample) {
+	int32_t rectified = ((sample < 0) ? -sample : sample) << ENVELOPE_FRAC_BITS;
+	int32_t delta = rectified - envelope->level;
+	envelope->level += delta >> ((delta > 0) ? envelope->attack_shift : envelope->release_shift);
+	return envelope->level >> ENVELOPE_FRAC_BITS;
+}
+
+// Returns: the envelope in sample units, without pushing a sample
+static inline FAST_CODE int32_t envelope_level(const envelope_t* envelope) {
+	return envelope->level >> ENVELOPE_FRAC_BITS;
+}
+
+#endif // ENVELOPE_H
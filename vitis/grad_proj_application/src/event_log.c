@@ -0,0 +1,283 @@
+#include "event_log.h"
+#include "delay.h"
+#include "tap_tempo.h"
+#include "lfo.h"
+#include "chorus.h"
+#include "console.h"
+
+// ============================================================================
+// EVENT LOG STATE VARIABLES
+// ============================================================================
+
+event_log_t event_log;
+static u32 dropped_reported = 0; // only touched by the consumer
+
+// ============================================================================
+// FORMATTING
+// ============================================================================
+// ms and cutoff conversions happen here rather than in the ISR that logged the event
+static u32 samples_to_ms(u32 samples) {
+	return (samples * 1000) / 48000;
+}
+
+// flanger delays are below a millisecond or a few of them
+static u32 samples_to_us(u32 samples) {
+	return (samples * 1000) / 48;
+}
+
+static u32 coeff_to_cutoff_hz(u32 coeff) {
+	return (coeff * 3035) / 100; // 30.4 * coeff, scaled by 10 for integer math
+}
+
+static const char* pattern_name(u32 pattern) {
+	return (pattern < DELAY_PATTERN_COUNT) ? delay_patterns[pattern].name : "?";
+}
+
+static const char* subdivision_name(u32 subdivision) {
+	return (subdivision < TAP_SUBDIVISION_COUNT) ? tap_subdivisions[subdivision].name : "?";
+}
+
+static const char* waveform_name(u32 waveform) {
+	return (waveform < LFO_WAVEFORM_COUNT) ? lfo_waveform_names[waveform] : "?";
+}
+
+static const char* chorus_style_name(u32 style) {
+	return (style < CHORUS_STYLE_COUNT) ? chorus_style_names[style] : "?";
+}
+
+static void print_event(const log_event_t* event) {
+	u32 a = event->arg[0];
+	u32 b = event->arg[1];
+	u32 c = event->arg[2];
+
+	switch (event->id) {
+	case LOG_DELAY_ON:
+		console_printf("Delay ON: %lu samples (~%lu ms)\r\n", a, samples_to_ms(a));
+		break;
+	case LOG_DELAY_OFF:
+		console_printf("Delay OFF\r\n");
+		break;
+	case LOG_DELAY_SAMPLES:
+		console_printf("Delay: %lu samples (~%lu ms)\r\n", a, samples_to_ms(a));
+		break;
+	case LOG_DELAY_MIX:
+		console_printf("Delay mix: %lu (~%lu%% wet) - %s\r\n", a, (a * 100) / 256, b ? "More" : "Less");
+		break;
+	case LOG_DELAY_FEEDBACK:
+		console_printf("Delay feedback: %lu (~%lu%%) - %s\r\n", a, (a * 100) / 256, b ? "More" : "Less");
+		break;
+	case LOG_DELAY_PATTERN:
+		console_printf("Delay pattern: %s (%lu taps)\r\n", pattern_name(a), b);
+		break;
+	case LOG_DELAY_MODE:
+		if (a == 0) {
+			console_printf("Delay: Adjusting TIME (current: %lu samples, ~%lu ms)\r\n", b, samples_to_ms(b));
+		}
+		else if (a == 1) {
+			console_printf("Delay: Adjusting MIX (current: %lu%% wet)\r\n", (b * 100) / 256);
+		}
+		else if (a == 2) {
+			console_printf("Delay: Adjusting FEEDBACK (current: %lu%%)\r\n", (b * 100) / 256);
+		}
+		else if (a == 3) {
+			console_printf("Delay: Adjusting PATTERN (current: %s)\r\n", pattern_name(b));
+		}
+		else if (a == 4) {
+			console_printf("Delay: Adjusting TAP SUBDIVISION (current: %s)\r\n", subdivision_name(b));
+		}
+		else if (a == 5) {
+			console_printf("Delay: Adjusting STYLE (current: %s)\r\n", b ? "REVERSE" : (c ? "TAPE" : "FORWARD"));
+		}
+		else {
+			console_printf("Delay: Adjusting DUCKING (current: %lu%%)\r\n", (b * 100) / 256);
+		}
+		break;
+	case LOG_DELAY_STYLE:
+		if (a) {
+			if (b > DELAY_REVERSE_CHUNK_MAX) b = DELAY_REVERSE_CHUNK_MAX;
+			console_printf("Delay: REVERSE (chunk %lu samples, ~%lu ms)\r\n", b, samples_to_ms(b));
+		}
+		else if (c) {
+			console_printf("Delay: TAPE (wow %lu.%lu Hz, flutter %lu.%lu Hz)\r\n",
+					   (u32) DELAY_TAPE_WOW_RATE / 10, (u32) DELAY_TAPE_WOW_RATE % 10,
+					   (u32) DELAY_TAPE_FLUTTER_RATE / 10, (u32) DELAY_TAPE_FLUTTER_RATE % 10);
+		}
+		else {
+			console_printf("Delay: FORWARD\r\n");
+		}
+		break;
+	case LOG_DELAY_DUCK:
+		console_printf("Delay ducking: %lu (~%lu%%) - %s\r\n", a, (a * 100) / 256, b ? "More" : "Less");
+		break;
+	case LOG_TAP:
+		console_printf("Tap at %lu\r\n", a);
+		break;
+	case LOG_TAP_SUBDIVISION:
+		console_printf("Tap subdivision: %s\r\n", subdivision_name(a));
+		break;
+	case LOG_TREMOLO_ON:
+		console_printf("Tremolo ON: rate=%lu, depth=%lu\r\n", a, b);
+		break;
+	case LOG_TREMOLO_OFF:
+		console_printf("Tremolo OFF\r\n");
+		break;
+	case LOG_TREMOLO_RATE:
+		console_printf("Tremolo rate: %lu.%lu Hz - %s\r\n", a / 10, a % 10, b ? "Faster" : "Slower");
+		break;
+	case LOG_TREMOLO_DEPTH:
+		console_printf("Tremolo depth: %lu (~%lu%%) - %s\r\n", a, (a * 100) / 256, b ? "More" : "Less");
+		break;
+	case LOG_TREMOLO_WAVEFORM:
+		console_printf("Tremolo waveform: %s\r\n", waveform_name(a));
+		break;
+	case LOG_TREMOLO_MODE:
+		if (a == 0) {
+			console_printf("Tremolo: Adjusting RATE (current: %lu.%lu Hz)\r\n", b / 10, b % 10);
+		}
+		else if (a == 1) {
+			console_printf("Tremolo: Adjusting DEPTH (current: %lu%%)\r\n", (c * 100) / 256);
+		}
+		else {
+			console_printf("Tremolo: Adjusting WAVEFORM (current: %s)\r\n", waveform_name(b));
+		}
+		break;
+	case LOG_CHORUS_ON:
+		console_printf("Chorus ON: rate=%lu.%lu Hz, delay=%lu, depth=%lu\r\n", a / 10, a % 10, b, c);
+		break;
+	case LOG_CHORUS_OFF:
+		console_printf("Chorus OFF\r\n");
+		break;
+	case LOG_CHORUS_RATE:
+		console_printf("Chorus rate: %lu.%lu Hz - %s\r\n", a / 10, a % 10, b ? "Faster" : "Slower");
+		break;
+	case LOG_CHORUS_DELAY:
+		console_printf("Chorus delay: %lu samples (~%lu ms) - %s\r\n", a, samples_to_ms(a), b ? "Longer" : "Shorter");
+		break;
+	case LOG_CHORUS_DEPTH:
+		console_printf("Chorus depth: %lu samples (~%lu ms) - %s\r\n", a, samples_to_ms(a), b ? "More" : "Less");
+		break;
+	case LOG_CHORUS_VOICES:
+		console_printf("Chorus voices: %lu - %s\r\n", a, b ? "More" : "Fewer");
+		break;
+	case LOG_CHORUS_SPREAD:
+		console_printf("Chorus spread: %lu%% - %s\r\n", a, b ? "Wider" : "Narrower");
+		break;
+	case LOG_CHORUS_STYLE:
+		console_printf("Chorus style: %s\r\n", chorus_style_name(a));
+		break;
+	case LOG_FLANGER_DELAY:
+		console_printf("Flanger delay: %lu samples (~%lu us) - %s\r\n", a, samples_to_us(a), b ? "Longer" : "Shorter");
+		break;
+	case LOG_FLANGER_DEPTH:
+		console_printf("Flanger depth: %lu samples (~%lu us) - %s\r\n", a, samples_to_us(a), b ? "More" : "Less");
+		break;
+	case LOG_FLANGER_FEEDBACK:
+		console_printf("Flanger feedback: %ld%% - %s\r\n", ((int32_t) a * 100) / 256, b ? "More" : "Less");
+		break;
+	case LOG_VIBRATO_DEPTH:
+		console_printf("Vibrato depth: %lu samples (~%lu us) - %s\r\n", a, samples_to_us(a), b ? "More" : "Less");
+		break;
+	case LOG_CHORUS_MODE:
+		if (c == CHORUS_STYLE_VIBRATO && a == 2) {
+			console_printf("Vibrato: Adjusting DEPTH (current: %lu samples, ~%lu us)\r\n", b, samples_to_us(b));
+		}
+		else if (c == CHORUS_STYLE_FLANGER && a >= 1 && a <= 3) {
+			if (a == 1) {
+				console_printf("Flanger: Adjusting DELAY (current: %lu samples, ~%lu us)\r\n", b, samples_to_us(b));
+			}
+			else if (a == 2) {
+				console_printf("Flanger: Adjusting DEPTH (current: %lu samples, ~%lu us)\r\n", b, samples_to_us(b));
+			}
+			else {
+				console_printf("Flanger: Adjusting FEEDBACK (current: %ld%%)\r\n", ((int32_t) b * 100) / 256);
+			}
+		}
+		else if (a == 0) {
+			console_printf("Chorus: Adjusting RATE (current: %lu.%lu Hz)\r\n", b / 10, b % 10);
+		}
+		else if (a == 1) {
+			console_printf("Chorus: Adjusting DELAY (current: %lu samples, ~%lu ms)\r\n", b, samples_to_ms(b));
+		}
+		else if (a == 2) {
+			console_printf("Chorus: Adjusting DEPTH (current: %lu samples, ~%lu ms)\r\n", b, samples_to_ms(b));
+		}
+		else if (a == 3) {
+			console_printf("Chorus: Adjusting VOICES (current: %lu)\r\n", b);
+		}
+		else if (a == 4) {
+			console_printf("Chorus: Adjusting SPREAD (current: %lu%%)\r\n", b);
+		}
+		else {
+			console_printf("Chorus: Adjusting STYLE (current: %s)\r\n", chorus_style_name(c));
+		}
+		break;
+	case LOG_LP_ADJUST:
+		if (a) {
+			console_printf("Adjusting LP Filter (current: %lu)\r\n", b);
+		}
+		else {
+			console_printf("LP Filter adjustment OFF (coeff: %lu)\r\n", b);
+		}
+		break;
+	case LOG_HP_ADJUST:
+		if (a) {
+			console_printf("Adjusting HP Filter (current: %lu)\r\n", b);
+		}
+		else {
+			console_printf("HP Filter adjustment OFF (coeff: %lu)\r\n", b);
+		}
+		break;
+	case LOG_LP_COEFF:
+		console_printf("LP Filter: %lu (cutoff: ~%lu Hz) - %s filtering\r\n", a, coeff_to_cutoff_hz(a), b ? "Less" : "More");
+		break;
+	case LOG_HP_COEFF:
+		console_printf("HP Filter: %lu (cutoff: ~%lu Hz) - %s filtering\r\n", a, coeff_to_cutoff_hz(a), b ? "More" : "Less");
+		break;
+	case LOG_ENC_TURN:
+		console_printf("%s turn\r\n", a ? "CW" : "CCW");
+		break;
+	case LOG_ENC_PRESS:
+		console_printf("enc btn press\r\n");
+		break;
+	default:
+		console_printf("[log] unknown event %lu (%lu, %lu, %lu)\r\n", event->id, a, b, c);
+		break;
+	}
+}
+
+// ============================================================================
+// DRAIN
+// ============================================================================
+u32 event_log_drain(u32 max_events) {
+	u32 printed = 0;
+
+	// only what the console queue has room for: the rest stays in the ring for a later pass
+	u32 dropped = event_log.dropped;
+	if (dropped != dropped_reported && console_free() >= CONSOLE_LINE_MAX) {
+		console_printf("[log] %lu events dropped\r\n", dropped - dropped_reported);
+		dropped_reported = dropped;
+	}
+
+	while (printed < max_events && console_free() >= CONSOLE_LINE_MAX) {
+		u32 tail = event_log.tail;
+		if (tail == event_log.head) {
+			break;
+		}
+		// print straight from the ring; the producer can't reuse this slot until tail moves
+		print_event(&event_log.events[tail & (EVENT_LOG_SIZE - 1)]);
+		event_log.tail = tail + 1;
+		printed++;
+	}
+
+	return printed;
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+void init_event_log(void) {
+	event_log.head = 0;
+	event_log.tail = 0;
+	event_log.dropped = 0;
+	dropped_reported = 0;
+}
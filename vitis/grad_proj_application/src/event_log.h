@@ -0,0 +1,106 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdint.h>
+#include "xil_types.h"
+#include "mem_placement.h"
+
+// ============================================================================
+// DEFERRED EVENT LOG
+// ============================================================================
+// xil_printf() blocks on the UART (~87 us per character at 115200 baud), so a
+// message printed from an ISR holds off sampling_ISR() for milliseconds.
+// ISRs call log_event() instead, which only stores the event id and up to three
+// raw argument values in a ring. The main() idle loop calls event_log_drain(),
+// which turns each event back into its message and queues it on the console
+// (console.h), so the drain never waits on the UART either.
+//
+// Same lock-free scheme as sample_ring.h: the producer only moves 'head', the
+// consumer only moves 'tail'. All producers are ISRs, and MicroBlaze interrupts
+// don't nest, so they never interleave and count as a single producer.
+// When the ring is full the event is dropped and counted; the drain reports it.
+
+#define EVENT_LOG_SIZE 64 // events (must be power of 2)
+
+typedef enum {
+	LOG_DELAY_ON = 0,       // delay_samples
+	LOG_DELAY_OFF,
+	LOG_DELAY_SAMPLES,      // delay_samples
+	LOG_DELAY_MIX,          // mix, 1 = more wet
+	LOG_DELAY_FEEDBACK,     // feedback, 1 = more
+	LOG_DELAY_PATTERN,      // delay_pattern, tap count
+	LOG_DELAY_MODE,         // delay_adjust_mode, value being adjusted
+	LOG_DELAY_STYLE,        // delay_reverse, chunk length (delay_samples), delay_tape
+	LOG_DELAY_DUCK,         // ducking depth, 1 = more
+	LOG_TAP,                // timestamp (samples)
+	LOG_TAP_SUBDIVISION,    // tap_subdivision
+	LOG_TREMOLO_ON,         // rate, depth
+	LOG_TREMOLO_OFF,
+	LOG_TREMOLO_RATE,       // rate, 1 = faster
+	LOG_TREMOLO_DEPTH,      // depth, 1 = more
+	LOG_TREMOLO_WAVEFORM,   // tremolo_waveform
+	LOG_TREMOLO_MODE,       // tremolo_adjust_mode, rate, depth (mode 2: waveform)
+	LOG_CHORUS_ON,          // rate, delay, depth
+	LOG_CHORUS_OFF,
+	LOG_CHORUS_RATE,        // rate, 1 = faster
+	LOG_CHORUS_DELAY,       // delay, 1 = longer
+	LOG_CHORUS_DEPTH,       // depth, 1 = more
+	LOG_CHORUS_VOICES,      // voices, 1 = more
+	LOG_CHORUS_SPREAD,      // spread (percent), 1 = wider
+	LOG_CHORUS_STYLE,       // chorus_style, 1 = next
+	LOG_FLANGER_DELAY,      // delay, 1 = longer
+	LOG_FLANGER_DEPTH,      // depth, 1 = more
+	LOG_FLANGER_FEEDBACK,   // feedback (signed Q8), 1 = more
+	LOG_VIBRATO_DEPTH,      // depth, 1 = more
+	LOG_CHORUS_MODE,        // chorus_adjust_mode, value being adjusted, chorus_style
+	LOG_LP_ADJUST,          // 1 = adjusting, coeff
+	LOG_HP_ADJUST,          // 1 = adjusting, coeff
+	LOG_LP_COEFF,           // coeff, 1 = less filtering
+	LOG_HP_COEFF,           // coeff, 1 = more filtering
+	LOG_ENC_TURN,           // 1 = CW
+	LOG_ENC_PRESS,
+	LOG_EVENT_COUNT
+} log_event_id_t;
+
+typedef struct {
+	u32 id;
+	u32 arg[3];
+} log_event_t;
+
+typedef struct {
+	log_event_t events[EVENT_LOG_SIZE];
+	volatile u32 head;      // total events logged (producer owned)
+	volatile u32 tail;      // total events printed (consumer owned)
+	volatile u32 dropped;   // events lost to a full ring (producer owned)
+} event_log_t;
+
+extern event_log_t event_log;
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+
+// ISR side: queue one event (never blocks)
+static inline FAST_CODE void log_event(log_event_id_t id, u32 arg0, u32 arg1, u32 arg2) {
+	u32 head = event_log.head;
+	if ((head - event_log.tail) >= EVENT_LOG_SIZE) {
+		event_log.dropped++;
+		return;
+	}
+	log_event_t* event = &event_log.events[head & (EVENT_LOG_SIZE - 1)];
+	event->id = id;
+	event->arg[0] = arg0;
+	event->arg[1] = arg1;
+	event->arg[2] = arg2;
+	event_log.head = head + 1; // publish only after the event is stored
+}
+
+// Main loop side: queue up to 'max_events' events on the console (and any new drops),
+// as many as console_free() has room for
+// Returns: number of events printed
+u32 event_log_drain(u32 max_events);
+
+// Empty the ring and clear the drop counter
+void init_event_log(void);
+
+#endif // EVENT_LOG_H
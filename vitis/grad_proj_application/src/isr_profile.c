@@ -0,0 +1,132 @@
+#include "isr_profile.h"
+#include "bsp.h"
+#include "chorus.h"
+#include "console.h"
+
+#if ISR_PROFILE
+
+// ============================================================================
+// PROFILING STATE VARIABLES
+// ============================================================================
+
+prof_stats_t prof_stats[PROF_STAGE_COUNT] FAST_DATA;
+u32 prof_stamp FAST_DATA = 0;
+u32 prof_isr_start FAST_DATA = 0;
+
+static prof_stats_t prof_snapshot[PROF_STAGE_COUNT]; // copied out of the ISR's view before printing
+
+// Console room a whole report needs: a stage line with every histogram bin is ~230
+// bytes, plus the header and summary lines
+#define PROF_REPORT_BYTES (PROF_STAGE_COUNT * 230 + 4 * 80)
+
+#if PROF_REPORT_BYTES > CONSOLE_TX_SIZE
+#error "an ISR profile report doesn't fit CONSOLE_TX_SIZE"
+#endif
+
+static const char* const prof_stage_names[PROF_STAGE_COUNT] = {
+	"IRQ entry",
+	"input fetch",
+	"DC removal",
+	"HPF",
+	"LPF cascade",
+	"limiter",
+	"delay",
+	"tremolo",
+	"chorus",
+	"looper",
+	"out limiter",
+	"PWM write",
+	"block",
+	"TOTAL",
+};
+
+static void prof_clear(prof_stats_t* stats) {
+	stats->min = 0xFFFFFFFF;
+	stats->max = 0;
+	stats->sum = 0;
+	stats->count = 0;
+	for (int bin = 0; bin < PROF_HIST_BINS; bin++) {
+		stats->hist[bin] = 0;
+	}
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+void isr_profile_report(void) {
+	// wait for a later call rather than drop half a report (the stats keep accumulating)
+	if (console_free() < PROF_REPORT_BYTES) {
+		return;
+	}
+
+	// copy and reset with interrupts off so a stage can't be half-updated while we read it
+	// (and the chorus settings are the ones in force when the stats were taken)
+	microblaze_disable_interrupts();
+	for (int stage = 0; stage < PROF_STAGE_COUNT; stage++) {
+		prof_snapshot[stage] = prof_stats[stage];
+		prof_clear(&prof_stats[stage]);
+	}
+	u32 voices = chorus_voices;
+	u8 style = chorus_style;
+	microblaze_enable_interrupts();
+
+	console_printf("---- ISR profile (cycles) ----\r\n");
+	for (int stage = 0; stage < PROF_STAGE_COUNT; stage++) {
+		prof_stats_t* stats = &prof_snapshot[stage];
+		if (stats->count == 0) {
+			continue;
+		}
+		console_printf("%-12s min %4lu max %5lu mean %4lu n %lu |", prof_stage_names[stage],
+				   stats->min, stats->max, stats->sum / stats->count, stats->count);
+		for (int bin = 0; bin < PROF_HIST_BINS; bin++) {
+			if (stats->hist[bin]) {
+				console_printf(" %lu:%lu", (u32) 1 << bin, stats->hist[bin]);
+			}
+		}
+		console_printf("\r\n");
+	}
+
+	prof_stats_t* entry = &prof_snapshot[PROF_ENTRY];
+	if (entry->count) {
+		console_printf("IRQ entry (%s path): mean %lu, max %lu cycles\r\n",
+				   SAMPLING_FAST_INTERRUPT ? "fast" : "generic", entry->sum / entry->count, entry->max);
+	}
+
+	// in the chorus style the stage grows with chorus_voices; its mean per voice (dry
+	// mix included) tells how many voices fit the budget. The flanger and vibrato run
+	// one voice on the short line whatever chorus_voices says, so they get the raw mean.
+	prof_stats_t* chorus = &prof_snapshot[PROF_CHORUS];
+	if (chorus->count) {
+		u32 mean = chorus->sum / chorus->count;
+		if (style == CHORUS_STYLE_CHORUS && voices > 0) {
+			console_printf("chorus: %lu voice(s), ~%lu cycles per voice\r\n", voices, mean / voices);
+		} else {
+			console_printf("chorus: %s, ~%lu cycles\r\n", chorus_style_names[style % CHORUS_STYLE_COUNT], mean);
+		}
+	}
+
+	// headroom = what's left of the sampling period after the ISR (per-sample mode)
+	prof_stats_t* total = &prof_snapshot[PROF_TOTAL];
+	if (total->count) {
+		u32 mean = total->sum / total->count;
+		console_printf("ISR uses %lu (max %lu) of %lu cycles per sample, %lu%% headroom\r\n",
+				   mean, total->max, (u32) RESET_VALUE,
+				   mean < RESET_VALUE ? ((RESET_VALUE - mean) * 100) / RESET_VALUE : 0);
+	}
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+void init_isr_profile(void) {
+	for (int stage = 0; stage < PROF_STAGE_COUNT; stage++) {
+		prof_clear(&prof_stats[stage]);
+	}
+}
+
+#else
+
+void isr_profile_report(void) {}
+void init_isr_profile(void) {}
+
+#endif
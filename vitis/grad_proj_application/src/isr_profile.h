@@ -0,0 +1,109 @@
+#ifndef ISR_PROFILE_H
+#define ISR_PROFILE_H
+
+#include <stdint.h>
+#include "xil_types.h"
+
+// ============================================================================
+// ISR PROFILING CONFIGURATION
+// ============================================================================
+// With ISR_PROFILE = 1 every pipeline stage is timestamped with a read of the
+// free-running cycle counter (axi_timer_0, counter 1, 100 MHz = CPU clock), and
+// min/max/mean plus a log2 histogram are kept per stage. isr_profile_report()
+// queues them on the console (console.h) from the main() idle loop.
+// With ISR_PROFILE = 0 every PROF_* macro expands to nothing (zero cost).
+//
+// The sampling period is RESET_VALUE (2048) cycles; the TOTAL row shows how much
+// of it sampling_ISR() uses. The ENTRY row is measured on the sampling timer itself
+// and is not part of TOTAL (see SAMPLING_FAST_INTERRUPT in bsp.h).
+
+#ifndef ISR_PROFILE
+#define ISR_PROFILE 0
+#endif
+
+// Pipeline stages (in the order they run)
+typedef enum {
+	PROF_ENTRY = 0,         // timer expiry -> first instruction of sampling_ISR() (interrupt entry latency)
+	PROF_INPUT_FETCH,       // stream grabber read
+	PROF_DC_REMOVAL,        // input smoothing + DC tracking
+	PROF_HPF,
+	PROF_LPF,               // 3-stage LPF cascade
+	PROF_LIMITER,           // input limiter
+	PROF_DELAY,
+	PROF_TREMOLO,
+	PROF_CHORUS,            // all chorus_voices voices (the report also divides it per voice)
+	PROF_LOOPER,
+	PROF_OUTPUT_LIMITER,
+	PROF_PWM_WRITE,         // PWM duty, stream grabber reset, IRQ clear
+	PROF_BLOCK,             // block mode: one audio_process_block() call (per block, not per sample)
+	PROF_TOTAL,             // whole sampling_ISR()
+	PROF_STAGE_COUNT
+} prof_stage_t;
+
+#define PROF_HIST_BINS 16 // bin k counts stages that took [2^k, 2^(k+1)) cycles
+
+typedef struct {
+	u32 min;
+	u32 max;
+	u32 sum;        // reset every report, so it can't overflow at 48.8 kHz * 2048 cycles
+	u32 count;
+	u32 hist[PROF_HIST_BINS];
+} prof_stats_t;
+
+#if ISR_PROFILE
+
+#include "cycle_timer.h"
+#include "mem_placement.h"
+
+extern prof_stats_t prof_stats[PROF_STAGE_COUNT];
+extern u32 prof_stamp;          // end of the previous stage
+extern u32 prof_isr_start;      // entry of the current sampling_ISR()
+
+static inline FAST_CODE void prof_record(prof_stage_t stage, u32 cycles) {
+	prof_stats_t* stats = &prof_stats[stage];
+	if (cycles < stats->min) stats->min = cycles;
+	if (cycles > stats->max) stats->max = cycles;
+	stats->sum += cycles;
+	stats->count++;
+
+	// log2 bucket: position of the highest set bit (clz is a single instruction with PCMP enabled)
+	u32 bin = 31 - __builtin_clz(cycles | 1);
+	if (bin >= PROF_HIST_BINS) bin = PROF_HIST_BINS - 1;
+	stats->hist[bin]++;
+}
+
+// Close 'stage' at the current time; the bookkeeping itself is not charged to the next stage
+static inline FAST_CODE void prof_mark(prof_stage_t stage) {
+	prof_record(stage, cycle_timer_read() - prof_stamp);
+	prof_stamp = cycle_timer_read();
+}
+
+#define PROF_ISR_ENTRY()        prof_record(PROF_ENTRY, sampling_timer_elapsed())
+#define PROF_ISR_START()        do { prof_isr_start = cycle_timer_read(); prof_stamp = prof_isr_start; } while (0)
+#define PROF_MARK(stage)        prof_mark(stage)
+#define PROF_ISR_END()          prof_record(PROF_TOTAL, cycle_timer_read() - prof_isr_start)
+#define PROF_SPAN_START(var)    u32 var = cycle_timer_read()
+#define PROF_SPAN_END(stage, var) prof_record(stage, cycle_timer_read() - (var))
+
+#else
+
+#define PROF_ISR_ENTRY()
+#define PROF_ISR_START()
+#define PROF_MARK(stage)
+#define PROF_ISR_END()
+#define PROF_SPAN_START(var)
+#define PROF_SPAN_END(stage, var)
+
+#endif
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+
+// Snapshot, print and reset the per-stage statistics (call from the main loop)
+void isr_profile_report(void);
+
+// Clear all statistics
+void init_isr_profile(void);
+
+#endif // ISR_PROFILE_H
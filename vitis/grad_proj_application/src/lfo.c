@@ -0,0 +1,192 @@
+#include "lfo.h"
+#include <stdint.h>
+
+// ============================================================================
+// SINE LOOKUP TABLE
+// ============================================================================
+// Generated by the compiler: each entry is a constant expression that evaluates
+// sin(x) with its Taylor series up to x^13, which is within 1e-9 of sin(x) on
+// 0..pi/2, far below the Q15 step. Changing LFO_SINE_QUARTER_LOG2 regenerates it
+// (the LFO_SINE_ROWS macros below expand to LFO_SINE_QUARTER entries).
+#define LFO_HALF_PI 1.57079632679489661923
+
+#define LFO_SIN_POLY(x) ((x) * (1 - (x) * (x) / 6 * (1 - (x) * (x) / 20 * (1 - (x) * (x) / 42 \
+                        * (1 - (x) * (x) / 72 * (1 - (x) * (x) / 110 * (1 - (x) * (x) / 156)))))))
+
+#define LFO_SINE_ENTRY(i) ((int16_t) (LFO_SIN_POLY((i) * (LFO_HALF_PI / LFO_SINE_QUARTER)) * LFO_PEAK + 0.5))
+
+#define LFO_SINE_ROWS_4(i)   LFO_SINE_ENTRY(i), LFO_SINE_ENTRY((i) + 1), LFO_SINE_ENTRY((i) + 2), LFO_SINE_ENTRY((i) + 3)
+#define LFO_SINE_ROWS_16(i)  LFO_SINE_ROWS_4(i), LFO_SINE_ROWS_4((i) + 4), LFO_SINE_ROWS_4((i) + 8), LFO_SINE_ROWS_4((i) + 12)
+#define LFO_SINE_ROWS_64(i)  LFO_SINE_ROWS_16(i), LFO_SINE_ROWS_16((i) + 16), LFO_SINE_ROWS_16((i) + 32), LFO_SINE_ROWS_16((i) + 48)
+#define LFO_SINE_ROWS_256(i) LFO_SINE_ROWS_64(i), LFO_SINE_ROWS_64((i) + 64), LFO_SINE_ROWS_64((i) + 128), LFO_SINE_ROWS_64((i) + 192)
+
+#if LFO_SINE_QUARTER_LOG2 == 6
+#define LFO_SINE_ROWS LFO_SINE_ROWS_64(0)
+#elif LFO_SINE_QUARTER_LOG2 == 8
+#define LFO_SINE_ROWS LFO_SINE_ROWS_256(0)
+#elif LFO_SINE_QUARTER_LOG2 == 10
+#define LFO_SINE_ROWS LFO_SINE_ROWS_256(0), LFO_SINE_ROWS_256(256), LFO_SINE_ROWS_256(512), LFO_SINE_ROWS_256(768)
+#else
+#error "LFO_SINE_QUARTER_LOG2 must be 6, 8 or 10"
+#endif
+
+const int16_t lfo_sine_quarter[LFO_SINE_QUARTER + 1] FAST_RODATA = {
+    LFO_SINE_ROWS, LFO_SINE_ENTRY(LFO_SINE_QUARTER)
+};
+
+// ============================================================================
+// LFO STATE VARIABLES
+// ============================================================================
+// Only touched from the audio context, except the rate/waveform/offset fields
+// (set from enc_ISR(), single stores that lfo_bank_run() picks up on its next call)
+lfo_t lfo_bank[LFO_COUNT] FAST_DATA;
+int32_t lfo_out[LFO_COUNT][BLOCK_SIZE] FAST_DATA;
+u32 lfo_block_count FAST_DATA = 1; // a lone process_* call (bench) reads lfo_out[][0]
+
+static uint32_t lfo_random_state FAST_DATA = 1;
+
+const char* const lfo_waveform_names[LFO_WAVEFORM_COUNT] = {
+    "sine", "triangle", "square", "random",
+};
+
+// ============================================================================
+// WAVEFORMS
+// ============================================================================
+// All return Q15, -LFO_PEAK to +LFO_PEAK, and start at 0 rising at phase 0
+// (square: high for the first half cycle)
+
+#define LFO_QUARTER_POSITION_BITS (LFO_SINE_QUARTER_LOG2 + 16) // entry + 16-bit fraction
+
+static inline FAST_CODE int32_t lfo_sine_q15(uint32_t phase) {
+    // position inside the quadrant; the 2nd and 4th quadrants run the table backward
+    // (the XOR mirrors it, 1/2^24 of a quadrant short of an exact reflection)
+    uint32_t position = (phase >> (30 - LFO_QUARTER_POSITION_BITS)) & ((1u << LFO_QUARTER_POSITION_BITS) - 1);
+    if (phase & LFO_PHASE_QUARTER) {
+        position ^= (1u << LFO_QUARTER_POSITION_BITS) - 1;
+    }
+    uint32_t index = position >> 16;
+    int32_t frac = (int32_t) (position & 0xFFFF);
+    int32_t now = lfo_sine_quarter[index];
+    int32_t value = now + (((lfo_sine_quarter[index + 1] - now) * frac) >> 16);
+
+    // the second half cycle is the first one negated
+    return (phase & 0x80000000u) ? -value : value;
+}
+
+static inline FAST_CODE int32_t lfo_triangle_q15(uint32_t phase) {
+    // a quarter cycle ahead, the rising half of the triangle starts at its trough
+    uint32_t shifted = (phase + LFO_PHASE_QUARTER) >> 16;             // 0..65535
+    int32_t ramp = (int32_t) ((shifted < 32768) ? shifted : 65535 - shifted); // 0..32767
+    return 2 * ramp - 32767;
+}
+
+static inline FAST_CODE int32_t lfo_square_q15(uint32_t phase) {
+    return (phase < 0x80000000u) ? LFO_PEAK : -LFO_PEAK;
+}
+
+static inline FAST_CODE int32_t lfo_random_q15(void) {
+    lfo_random_state = lfo_random_state * 1664525u + 1013904223u;
+    return ((int32_t) (lfo_random_state >> 17) << 1) - LFO_PEAK; // -32767..32767
+}
+
+// ============================================================================
+// BANK
+// ============================================================================
+// One loop per LFO, with the waveform chosen outside it
+FAST_CODE void lfo_bank_run(u32 count, u32 active) {
+    for (u32 k = 0; k < LFO_COUNT; k++) {
+        lfo_t* lfo = &lfo_bank[k];
+        if (!(active & LFO_BIT(k))) {
+            // nobody reads it: keep the phase running, skip the waveform
+            lfo->phase += lfo->phase_inc * count;
+            continue;
+        }
+        // read once: update_chorus_spread() may change it from enc_ISR() mid-run, and
+        // removing a different offset than was added would shift the base phase
+        uint32_t offset = lfo->phase_offset;
+        uint32_t phase = lfo->phase + offset;
+        uint32_t phase_inc = lfo->phase_inc;
+        int32_t* out = lfo_out[k];
+
+        switch (lfo->waveform) {
+        case LFO_TRIANGLE:
+            for (u32 i = 0; i < count; i++) {
+                phase += phase_inc;
+                out[i] = lfo_triangle_q15(phase);
+            }
+            break;
+        case LFO_SQUARE:
+            for (u32 i = 0; i < count; i++) {
+                phase += phase_inc;
+                out[i] = lfo_square_q15(phase);
+            }
+            break;
+        case LFO_RANDOM: {
+            int32_t held = lfo->held;
+            for (u32 i = 0; i < count; i++) {
+                uint32_t next = phase + phase_inc;
+                if (next < phase) {
+                    held = lfo_random_q15(); // wrapped: new cycle, new level
+                }
+                phase = next;
+                out[i] = held;
+            }
+            lfo->held = held;
+            break;
+        }
+        default:
+            for (u32 i = 0; i < count; i++) {
+                phase += phase_inc;
+                out[i] = lfo_sine_q15(phase);
+            }
+            break;
+        }
+
+        lfo->phase = phase - offset;
+    }
+    lfo_block_count = count;
+}
+
+// ============================================================================
+// PHASE INCREMENT CALCULATION
+// ============================================================================
+u32 lfo_phase_inc(u32 rate) {
+    // rate is in units of 0.1 Hz (e.g., 10 = 1.0 Hz)
+    // Phase increment = rate_hz * 2^32 / sample_rate
+    //                 = (rate << 32) / (LFO_SAMPLE_RATE * 10)
+    // 64-bit math; the result fits 32 bits up to the sample rate
+    uint64_t numerator = (uint64_t) rate << 32;
+    uint64_t denominator = (uint64_t) LFO_SAMPLE_RATE * 10;
+    return (u32) (numerator / denominator);
+}
+
+void lfo_set_rate(lfo_id_t lfo, u32 rate) {
+    lfo_bank[lfo].phase_inc = lfo_phase_inc(rate);
+}
+
+void lfo_set_waveform(lfo_id_t lfo, lfo_waveform_t waveform) {
+    lfo_bank[lfo].waveform = (waveform < LFO_WAVEFORM_COUNT) ? waveform : LFO_SINE;
+}
+
+void lfo_set_phase_offset(lfo_id_t lfo, uint32_t offset) {
+    lfo_bank[lfo].phase_offset = offset;
+}
+
+void lfo_reset(lfo_id_t lfo) {
+    lfo_bank[lfo].phase = 0;
+    lfo_bank[lfo].held = 0;
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+void init_lfo_bank(void) {
+    for (u32 k = 0; k < LFO_COUNT; k++) {
+        lfo_reset((lfo_id_t) k);
+        for (u32 i = 0; i < BLOCK_SIZE; i++) {
+            lfo_out[k][i] = 0;
+        }
+    }
+    lfo_block_count = 1;
+    lfo_random_state = 1;
+}
@@ -0,0 +1,123 @@
+#ifndef LFO_H
+#define LFO_H
+
+#include <stdint.h>
+#include "xil_types.h"
+#include "mem_placement.h"
+#include "block_engine.h"
+
+// ============================================================================
+// LFO BANK CONFIGURATION
+// ============================================================================
+// Every modulation source in the chain is one entry of lfo_bank[]. The audio
+// chain runs the whole bank once per block (once per sample in per-sample mode)
+// with lfo_bank_run(), one tight loop per LFO, and the effects read the values
+// of the block from lfo_out[] through lfo_tail(). The caller passes the LFOs
+// whose effect is on (LFO_BIT()); the others only advance their phase, so they
+// stay in step, and their lfo_out[] values are left stale until they are used again.
+//
+// Phase: full 32-bit accumulator, one cycle = 2^32, wrapping by itself. The
+// increment for 0.1 Hz is ~880, so every rate is within 0.2% of its setting
+// (the old 8-bit fraction had to round slow rates up to an increment of 1).
+//
+// Sine: a quarter-wave Q15 table (lfo_sine_quarter[]), folded by symmetry: the
+// top 2 phase bits pick the quadrant, the next LFO_SINE_QUARTER_LOG2 bits the
+// entry and the 16 below interpolate to the next entry. With 256 entries per
+// quarter that is a 1024-point cycle in 514 bytes, within ~1 LSB of Q15 after
+// interpolation. The compiler computes the table from a polynomial (lfo.c).
+//
+// Output: Q15, -LFO_PEAK to +LFO_PEAK for every waveform, so a user scales it
+// by depth with '(value * depth) >> 15'.
+
+#define LFO_SAMPLE_RATE       48828 // match system sample rate
+
+#define LFO_SINE_QUARTER_LOG2 8
+#define LFO_SINE_QUARTER      (1u << LFO_SINE_QUARTER_LOG2) // entries per quarter cycle
+#define LFO_PEAK              32767
+
+// A quarter cycle of phase, e.g. for a 90-degree phase offset
+#define LFO_PHASE_QUARTER     0x40000000u
+
+typedef enum {
+	LFO_TREMOLO = 0,
+	LFO_CHORUS,         // chorus voice 1; voices 2 to CHORUS_VOICES_MAX follow in order
+	LFO_CHORUS_2,
+	LFO_CHORUS_3,
+	LFO_CHORUS_4,
+	LFO_TAPE_WOW,       // tape delay: slow drift of the read head
+	LFO_TAPE_FLUTTER,   // tape delay: fast wobble of the read head
+	LFO_COUNT
+} lfo_id_t;
+
+// Bit of one LFO in the 'active' mask of lfo_bank_run()
+#define LFO_BIT(lfo)          (1u << (lfo))
+#define LFO_ALL               (LFO_BIT(LFO_COUNT) - 1)
+
+typedef enum {
+	LFO_SINE = 0,
+	LFO_TRIANGLE,
+	LFO_SQUARE,
+	LFO_RANDOM,         // sample and hold: a new random level every cycle
+	LFO_WAVEFORM_COUNT
+} lfo_waveform_t;
+
+typedef struct {
+	uint32_t phase;         // advanced by lfo_bank_run()
+	uint32_t phase_inc;     // per sample; written by lfo_set_rate()
+	uint32_t phase_offset;  // added to the phase when the waveform is read
+	u8 waveform;            // lfo_waveform_t
+	int32_t held;           // LFO_RANDOM: level of the current cycle
+} lfo_t;
+
+// ============================================================================
+// LFO STATE VARIABLES
+// ============================================================================
+
+// lfo_sine_quarter[i] = 32767 * sin((i * pi/2) / LFO_SINE_QUARTER), one extra entry
+// at pi/2 for the interpolation
+extern const int16_t lfo_sine_quarter[LFO_SINE_QUARTER + 1];
+
+extern lfo_t lfo_bank[LFO_COUNT];
+
+// Values of the last lfo_bank_run(): lfo_out[lfo][i] for sample i of the block
+extern int32_t lfo_out[LFO_COUNT][BLOCK_SIZE];
+extern u32 lfo_block_count;
+
+// ============================================================================
+// LFO HELPERS
+// ============================================================================
+
+// Returns: the values of one LFO for the last 'count' samples of the current block
+// (the block stages skip warm-up samples at the front, never at the end)
+static inline FAST_CODE const int32_t* lfo_tail(lfo_id_t lfo, u32 count) {
+	return &lfo_out[lfo][lfo_block_count - count];
+}
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+
+// Advance every LFO by 'count' samples (at most BLOCK_SIZE) and store the values of
+// those in 'active' (LFO_BIT() of each, LFO_ALL for the whole bank)
+void lfo_bank_run(u32 count, u32 active);
+
+// Returns: phase increment for 'rate' (in 0.1 Hz units)
+u32 lfo_phase_inc(u32 rate);
+
+// Set the rate of one LFO (in 0.1 Hz units); the division stays out of the ISR
+void lfo_set_rate(lfo_id_t lfo, u32 rate);
+
+void lfo_set_waveform(lfo_id_t lfo, lfo_waveform_t waveform);
+
+// Shift one LFO against the others (2^32 = one cycle)
+void lfo_set_phase_offset(lfo_id_t lfo, uint32_t offset);
+
+// Restart one LFO at phase 0
+void lfo_reset(lfo_id_t lfo);
+
+// Restart every LFO and clear the outputs (rates, waveforms and offsets are kept)
+void init_lfo_bank(void);
+
+extern const char* const lfo_waveform_names[LFO_WAVEFORM_COUNT];
+
+#endif // LFO_H
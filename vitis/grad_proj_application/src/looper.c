@@ -0,0 +1,356 @@
+#include "looper.h"
+#include "console.h"
+#include <string.h>
+
+// ============================================================================
+// LOOPER STORAGE
+// ============================================================================
+// On the board the loop lives in the .looper section (lscript.ld), which runs from
+// the end of the stack to the end of DDR; the host build gets a static buffer
+#if defined(__MICROBLAZE__)
+extern delay_sample_t __looper_start[];
+extern delay_sample_t __looper_end[];
+#define LOOPER_STORAGE          __looper_start
+#define LOOPER_STORAGE_SAMPLES  ((u32) (__looper_end - __looper_start))
+#else
+static delay_sample_t looper_host_storage[LOOPER_HOST_SAMPLES];
+#define LOOPER_STORAGE          looper_host_storage
+#define LOOPER_STORAGE_SAMPLES  LOOPER_HOST_SAMPLES
+#endif
+
+#define LOOPER_WINDOW_MASK  (LOOPER_WINDOW_CHUNKS - 1)
+#define LOOPER_CHUNK_BYTES  (LOOPER_CHUNK_SIZE * sizeof(delay_sample_t))
+
+static const char* const looper_state_names[LOOPER_STATE_COUNT] = {
+	"EMPTY", "RECORD", "PLAY", "OVERDUB", "STOPPED"
+};
+
+// ============================================================================
+// LOOPER STATE VARIABLES
+// ============================================================================
+volatile u8 looper_state = LOOPER_EMPTY;
+volatile u32 looper_underruns = 0;
+
+// BRAM window shared by the audio side and looper_service()
+// A slot belongs to the service until chunks_ready passes it, then to the audio
+// side until chunks_done passes it, then to the service again
+static delay_sample_t looper_window[LOOPER_WINDOW_CHUNKS * LOOPER_CHUNK_SIZE] FAST_DATA;
+static volatile u8 slot_mode[LOOPER_WINDOW_CHUNKS] FAST_DATA;  // looper_state_t the chunk was prepared for (EMPTY = silent)
+static u32 slot_chunk[LOOPER_WINDOW_CHUNKS];                     // DDR chunk the slot was read from / goes back to
+
+// Free-running chunk counters; the slot of chunk n is (n & LOOPER_WINDOW_MASK)
+static volatile u32 chunks_ready FAST_DATA = 0; // prepared by the service (service owned)
+static volatile u32 chunks_done FAST_DATA = 0;  // finished by the audio side (audio owned)
+static u32 chunks_flushed = 0;                  // written back to DDR (service only)
+
+// Audio side only
+static u32 chunk_pos FAST_DATA = 0;             // next sample within chunk 'chunks_done'
+
+// Button side only (the counters are read by the service)
+static volatile u32 press_requests = 0;
+static volatile u32 stop_requests = 0;
+static u32 last_press_time = 0;
+static u8 last_press_valid = 0;
+
+// Service only
+static u32 presses_seen = 0;
+static u32 stops_seen = 0;
+static u32 record_chunks = 0;   // chunks recorded so far (first pass)
+static u32 loop_chunks = 0;     // loop length once recording has finished
+static u32 play_chunk = 0;      // next DDR chunk to read in
+static u8 finish_recording = 0; // stop was pressed before LOOPER_MIN_CHUNKS were recorded
+static u8 play_restart = 0;     // playback restarts from the first chunk (after a stop)
+static u32 dirty_until = 0;     // chunks_ready after the last recorded/overdubbed chunk
+
+// ============================================================================
+// BUTTON SIDE
+// ============================================================================
+void looper_press(u32 timestamp) {
+	if (last_press_valid && (timestamp - last_press_time) < LOOPER_DOUBLE_PRESS) {
+		// second press of a double press; a third press starts over as a single one
+		last_press_valid = 0;
+		stop_requests++;
+	}
+	else {
+		last_press_valid = 1;
+		last_press_time = timestamp;
+		press_requests++;
+	}
+}
+
+// ============================================================================
+// AUDIO SIDE
+// ============================================================================
+FAST_CODE int32_t process_looper(int32_t input) {
+	u32 chunk = chunks_done;
+	if (chunk == chunks_ready) {
+		// the main loop hasn't prepared the next chunk yet: pass through and hold position
+		looper_underruns++;
+		return input;
+	}
+
+	u32 slot = chunk & LOOPER_WINDOW_MASK;
+	delay_sample_t* sample = &looper_window[slot * LOOPER_CHUNK_SIZE + chunk_pos];
+	int32_t output = input;
+
+	switch (slot_mode[slot]) {
+	case LOOPER_RECORD:
+		*sample = delay_line_pack(input);
+		break;
+	case LOOPER_PLAY:
+		output = input + *sample;
+		break;
+	case LOOPER_OVERDUB: {
+		int32_t loop = *sample;
+		*sample = delay_line_pack(loop + input);
+		output = input + loop;
+		break;
+	}
+	default:
+		break;
+	}
+
+	if (++chunk_pos == LOOPER_CHUNK_SIZE) {
+		chunk_pos = 0;
+		chunks_done = chunk + 1; // hand the slot back to the service
+	}
+	return output;
+}
+
+// Same as process_looper(), but the mode is looked up once per chunk
+FAST_CODE void process_looper_block(int32_t *samples, u32 count) {
+	u32 i = 0;
+	while (i < count) {
+		u32 chunk = chunks_done;
+		if (chunk == chunks_ready) {
+			looper_underruns += count - i;
+			return;
+		}
+
+		u32 slot = chunk & LOOPER_WINDOW_MASK;
+		delay_sample_t* loop = &looper_window[slot * LOOPER_CHUNK_SIZE + chunk_pos];
+		u32 run = LOOPER_CHUNK_SIZE - chunk_pos;
+		if (run > count - i) run = count - i;
+		int32_t* run_samples = samples + i;
+
+		switch (slot_mode[slot]) {
+		case LOOPER_RECORD:
+			for (u32 n = 0; n < run; n++) {
+				loop[n] = delay_line_pack(run_samples[n]);
+			}
+			break;
+		case LOOPER_PLAY:
+			for (u32 n = 0; n < run; n++) {
+				run_samples[n] += loop[n];
+			}
+			break;
+		case LOOPER_OVERDUB:
+			for (u32 n = 0; n < run; n++) {
+				int32_t loop_sample = loop[n];
+				loop[n] = delay_line_pack(loop_sample + run_samples[n]);
+				run_samples[n] += loop_sample;
+			}
+			break;
+		default:
+			break;
+		}
+
+		chunk_pos += run;
+		if (chunk_pos == LOOPER_CHUNK_SIZE) {
+			chunk_pos = 0;
+			chunks_done = chunk + 1;
+		}
+		i += run;
+	}
+}
+
+// ============================================================================
+// STATE MACHINE (main loop)
+// ============================================================================
+static void set_state(looper_state_t state) {
+	looper_state = state;
+	if (state == LOOPER_PLAY || state == LOOPER_OVERDUB || state == LOOPER_STOPPED) {
+		u32 length = loop_chunks * LOOPER_CHUNK_SIZE;
+		console_printf("Looper: %s (loop %lu samples, %lu.%lu s)\r\n", looper_state_names[state], length,
+				   length / LOOPER_SAMPLE_RATE, ((length % LOOPER_SAMPLE_RATE) * 10) / LOOPER_SAMPLE_RATE);
+	}
+	else {
+		console_printf("Looper: %s\r\n", looper_state_names[state]);
+	}
+}
+
+// The recorded chunks become the loop; playback starts over from its first chunk
+static void close_loop(looper_state_t next) {
+	loop_chunks = record_chunks;
+	play_chunk = 0;
+	finish_recording = 0;
+	set_state(next);
+}
+
+static void handle_press(void) {
+	switch (looper_state) {
+	case LOOPER_EMPTY:
+		record_chunks = 0;
+		finish_recording = 0;
+		set_state(LOOPER_RECORD);
+		break;
+	case LOOPER_RECORD:
+		if (record_chunks >= LOOPER_MIN_CHUNKS) {
+			close_loop(LOOPER_PLAY);
+		}
+		else {
+			finish_recording = 1; // prepare_chunk() closes the loop once it is long enough
+		}
+		break;
+	case LOOPER_PLAY:
+		set_state(LOOPER_OVERDUB);
+		break;
+	case LOOPER_OVERDUB:
+		set_state(LOOPER_PLAY);
+		break;
+	case LOOPER_STOPPED:
+		play_chunk = 0;
+		play_restart = 1;
+		set_state(LOOPER_PLAY);
+		break;
+	default:
+		break;
+	}
+}
+
+static void handle_stop(void) {
+	switch (looper_state) {
+	case LOOPER_RECORD:
+		if (record_chunks >= LOOPER_MIN_CHUNKS) {
+			close_loop(LOOPER_STOPPED);
+		}
+		else {
+			finish_recording = 0;
+			set_state(LOOPER_EMPTY); // too short to keep
+		}
+		break;
+	case LOOPER_PLAY:
+	case LOOPER_OVERDUB:
+		set_state(LOOPER_STOPPED);
+		break;
+	case LOOPER_STOPPED:
+		loop_chunks = 0;
+		set_state(LOOPER_EMPTY);
+		break;
+	default:
+		break;
+	}
+}
+
+// ============================================================================
+// CHUNK TRANSFERS (main loop)
+// ============================================================================
+static void prepare_chunk(u32 ready) {
+	u32 slot = ready & LOOPER_WINDOW_MASK;
+	delay_sample_t* chunk = &looper_window[slot * LOOPER_CHUNK_SIZE];
+	u8 mode = LOOPER_EMPTY;
+
+	switch (looper_state) {
+	case LOOPER_RECORD:
+		// write-only: nothing to read in, the slot just has to be free
+		mode = LOOPER_RECORD;
+		slot_chunk[slot] = record_chunks++;
+		dirty_until = ready + 1;
+		if ((finish_recording && record_chunks >= LOOPER_MIN_CHUNKS) ||
+			(record_chunks == looper_capacity() / LOOPER_CHUNK_SIZE)) {
+			close_loop(LOOPER_PLAY);
+		}
+		break;
+	case LOOPER_PLAY:
+	case LOOPER_OVERDUB:
+		if (play_restart) {
+			// the chunks written just before the stop may still be in the window; stay
+			// silent until they are back in DDR, so the first pass reads what was played
+			if ((int32_t) (dirty_until - chunks_flushed) > 0) {
+				break;
+			}
+			play_restart = 0;
+		}
+		mode = looper_state;
+		if (mode == LOOPER_OVERDUB) {
+			dirty_until = ready + 1;
+		}
+		slot_chunk[slot] = play_chunk;
+		memcpy(chunk, &LOOPER_STORAGE[play_chunk * LOOPER_CHUNK_SIZE], LOOPER_CHUNK_BYTES);
+		if (++play_chunk == loop_chunks) {
+			play_chunk = 0;
+		}
+		break;
+	default:
+		break;
+	}
+
+	slot_mode[slot] = mode;
+}
+
+u32 looper_capacity(void) {
+	return LOOPER_STORAGE_SAMPLES & ~(LOOPER_CHUNK_SIZE - 1);
+}
+
+u32 looper_length(void) {
+	return (looper_state == LOOPER_EMPTY || looper_state == LOOPER_RECORD) ? 0 : loop_chunks * LOOPER_CHUNK_SIZE;
+}
+
+void looper_service(void) {
+	// button presses (single presses first: a double press is a press followed by a stop)
+	u32 presses = press_requests;
+	while (presses_seen != presses) {
+		presses_seen++;
+		handle_press();
+	}
+	u32 stops = stop_requests;
+	if (stops_seen != stops) {
+		stops_seen = stops;
+		handle_stop();
+	}
+
+	// write back every chunk the audio side has recorded or overdubbed
+	u32 done = chunks_done;
+	while (chunks_flushed != done) {
+		u32 slot = chunks_flushed & LOOPER_WINDOW_MASK;
+		u8 mode = slot_mode[slot];
+		if (mode == LOOPER_RECORD || mode == LOOPER_OVERDUB) {
+			memcpy(&LOOPER_STORAGE[slot_chunk[slot] * LOOPER_CHUNK_SIZE], &looper_window[slot * LOOPER_CHUNK_SIZE], LOOPER_CHUNK_BYTES);
+		}
+		chunks_flushed++;
+	}
+
+	// refill the window with the chunks that come next
+	u32 ready = chunks_ready;
+	while ((ready - chunks_flushed) < LOOPER_WINDOW_CHUNKS) {
+		prepare_chunk(ready);
+		ready++;
+		chunks_ready = ready; // publish only after the slot is filled
+	}
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+void init_looper(void) {
+	looper_state = LOOPER_EMPTY;
+	looper_underruns = 0;
+	presses_seen = press_requests;
+	stops_seen = stop_requests;
+	last_press_valid = 0;
+	record_chunks = 0;
+	loop_chunks = 0;
+	play_chunk = 0;
+	finish_recording = 0;
+	play_restart = 0;
+	dirty_until = 0;
+
+	// the audio side starts on a silent window, so it never waits for the first service pass
+	for (u32 i = 0; i < LOOPER_WINDOW_CHUNKS; i++) {
+		slot_mode[i] = LOOPER_EMPTY;
+	}
+	chunk_pos = 0;
+	chunks_done = 0;
+	chunks_flushed = 0;
+	chunks_ready = LOOPER_WINDOW_CHUNKS;
+}
@@ -0,0 +1,91 @@
+#ifndef LOOPER_H
+#define LOOPER_H
+
+#include <stdint.h>
+#include "xil_types.h"
+#include "mem_placement.h"
+#include "delay_line.h"
+
+// ============================================================================
+// LOOPER CONFIGURATION
+// ============================================================================
+// Records the chain output into the .looper section of lscript.ld (everything in
+// DDR above the stack, ~127 MB = ~22 minutes of 16-bit samples) and plays it back
+// under the live signal, with overdub.
+//
+// The audio side (process_looper(), in sampling_ISR or the block engine) never
+// touches DDR. It works on a small window of LOOPER_CHUNK_SIZE-sample chunks in
+// BRAM. looper_service() in the main loop stays up to LOOPER_WINDOW_CHUNKS chunks
+// ahead of it: finished chunks are written back to DDR and upcoming ones are
+// read in, each as one sequential copy of whole cache lines. Every window slot
+// carries the mode the service prepared it for (silent, record, play, overdub),
+// so a button press takes effect at the first chunk the service has not handed
+// out yet: ~LOOPER_WINDOW_CHUNKS * LOOPER_CHUNK_SIZE samples (~21 ms) later, and
+// loops are always a whole number of chunks.
+//
+// If the main loop falls behind, the audio side passes the signal through and
+// holds its position until the next chunk is ready (counted in looper_underruns).
+//
+// The looper is driven from the encoder button while no effect owns the encoder.
+
+#define LOOPER_SAMPLE_RATE     48828 // match system sample rate
+
+#define LOOPER_CHUNK_SIZE      128  // samples per DDR transfer (256 bytes = 16 of the 16-byte cache lines), power of 2
+#define LOOPER_WINDOW_CHUNKS   8    // chunks in the BRAM window (2 KB), power of 2
+
+// Loops are at least a full window long, so a chunk is always written back to DDR
+// before the service reads it in again for the next pass
+#define LOOPER_MIN_CHUNKS      LOOPER_WINDOW_CHUNKS
+
+// Samples of storage when the looper is built for the host (no lscript.ld)
+#ifndef LOOPER_HOST_SAMPLES
+#define LOOPER_HOST_SAMPLES    (1u << 20)
+#endif
+
+// Encoder button presses closer than this are a double press (stop / clear)
+#define LOOPER_DOUBLE_PRESS    19531 // 0.4 s at 48.8 kHz
+
+typedef enum {
+	LOOPER_EMPTY = 0,   // nothing recorded
+	LOOPER_RECORD,      // first pass: sets the loop length
+	LOOPER_PLAY,
+	LOOPER_OVERDUB,     // play and add the input on top of the loop
+	LOOPER_STOPPED,     // loop kept, silent; the next press plays it from the start
+	LOOPER_STATE_COUNT
+} looper_state_t;
+
+// ============================================================================
+// LOOPER STATE VARIABLES (extern for access from bsp.c)
+// ============================================================================
+
+extern volatile u8 looper_state;        // looper_state_t, owned by looper_service()
+extern volatile u32 looper_underruns;   // samples passed through while the audio side waited for a chunk
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+
+// Button side (ISR): one press of the looper button at 'timestamp' (samples)
+// single press: empty -> record -> play <-> overdub, stopped -> play
+// double press: stop, or clear the loop when already stopped
+void looper_press(u32 timestamp);
+
+// Audio side: add the loop to one sample (and record/overdub it)
+int32_t process_looper(int32_t input);
+
+// Audio side: same for a block, in place
+void process_looper_block(int32_t *samples, u32 count);
+
+// Main loop side: apply requests, write back finished chunks and prepare the next ones
+void looper_service(void);
+
+// Loop length in samples (0 while empty or recording)
+u32 looper_length(void);
+
+// Samples of DDR available for recording
+u32 looper_capacity(void);
+
+// Forget the loop and hand the audio side a silent window
+void init_looper(void);
+
+#endif // LOOPER_H
@@ -1,6 +1,13 @@
 #include "xil_cache.h"		                /* Cache Drivers */
 #include "bsp.h"
 #include "stream_grabber.h"
+#include "mem_placement.h"
+#include "isr_profile.h"
+#include "bench.h"
+#include "event_log.h"
+#include "tap_tempo.h"
+#include "looper.h"
+#include "console.h"
 
 unsigned seqf, seql, seq_old = 0;
 
@@ -11,8 +18,50 @@ int main() {
 	Xil_DCacheEnable();
 
 	BSP_init();
+	mem_placement_report();
+#if BENCHMARK
+	bench_run(); // runs with interrupts off, then hands a freshly initialized chain back to sampling_ISR()
+#endif
+
+#if BLOCK_PROCESSING
+	block_engine_report();
+	u32 last_report_tick = sys_tick_counter;
+#endif
+#if ISR_PROFILE
+	u32 last_profile_tick = sys_tick_counter;
+#endif
 
 	while (1) {
+#if BLOCK_PROCESSING
+		// run the effects over every block the sampling ISR has filled
+		while (block_engine_service()) {}
+
+		// report latency and under/overruns roughly every 10 seconds
+		if ((sys_tick_counter - last_report_tick) >= (10 * BLOCK_SAMPLE_RATE)) {
+			last_report_tick = sys_tick_counter;
+			block_engine_report();
+		}
+#endif
+
+		// format what the button/encoder ISRs logged into the console queue, and hand
+		// the UART what its TX FIFO takes without waiting (see console.h)
+		event_log_drain(EVENT_LOG_SIZE);
+		console_service();
+
+		// turn queued tap-tempo presses into delay_samples
+		tap_tempo_service();
+
+		// move looper chunks between DDR and the BRAM window the audio side works on
+		looper_service();
+
+#if ISR_PROFILE
+		// dump per-stage cycle counts roughly once per second
+		if ((sys_tick_counter - last_profile_tick) >= 48828) {
+			last_profile_tick = sys_tick_counter;
+			isr_profile_report();
+		}
+#endif
+
 		// Print roughly once per second (assuming 48kHz interrupt rate)
 //		if (sys_tick_counter >= 48000) {
 //
@@ -0,0 +1,25 @@
+#include "mem_placement.h"
+#include "xil_printf.h"
+
+// ============================================================================
+// LINKER SYMBOLS (defined in lscript.ld)
+// ============================================================================
+extern char __lmb_text_start[], __lmb_text_end[];
+extern char __lmb_rodata_start[], __lmb_rodata_end[];
+extern char __lmb_data_start[], __lmb_data_end[];
+extern char __looper_start[], __looper_end[];
+
+// ============================================================================
+// REPORT
+// ============================================================================
+void mem_placement_report(void) {
+	u32 text_size = (u32) (__lmb_text_end - __lmb_text_start);
+	u32 rodata_size = (u32) (__lmb_rodata_end - __lmb_rodata_start);
+	u32 data_size = (u32) (__lmb_data_end - __lmb_data_start);
+
+	xil_printf("LMB .lmb_text:   0x%08lx %lu bytes\r\n", (UINTPTR) __lmb_text_start, text_size);
+	xil_printf("LMB .lmb_rodata: 0x%08lx %lu bytes\r\n", (UINTPTR) __lmb_rodata_start, rodata_size);
+	xil_printf("LMB .lmb_data:   0x%08lx %lu bytes\r\n", (UINTPTR) __lmb_data_start, data_size);
+	xil_printf("LMB total: %lu bytes\r\n", text_size + rodata_size + data_size);
+	xil_printf("DDR .looper:     0x%08lx %lu bytes\r\n", (UINTPTR) __looper_start, (u32) (__looper_end - __looper_start));
+}
@@ -0,0 +1,41 @@
+#ifndef MEM_PLACEMENT_H
+#define MEM_PLACEMENT_H
+
+#include "xil_types.h"
+
+// ============================================================================
+// MEMORY PLACEMENT CONFIGURATION
+// ============================================================================
+// lscript.ld puts everything in DDR (mig_7series_0_memaddr) by default. Code and
+// data tagged with these macros go to the 64 KB LMB BRAM instead, which is a
+// single-cycle access with no cache miss possible:
+//   FAST_CODE   -> .lmb_text    (sampling_ISR, effect process_* functions)
+//   FAST_DATA   -> .lmb_data    (filter/LFO state, rings, short delay window)
+//   FAST_RODATA -> .lmb_rodata  (LFO sine table)
+// const and non-const data need separate sections, otherwise gcc reports a
+// section type conflict.
+//
+// Run tools/mem_report.sh on the .elf to see which symbols landed where.
+
+#ifndef LMB_PLACEMENT
+#define LMB_PLACEMENT 1 // 0 = leave everything in DDR
+#endif
+
+#if LMB_PLACEMENT && defined(__MICROBLAZE__)
+#define FAST_CODE   __attribute__((section(".lmb_text")))
+#define FAST_DATA   __attribute__((section(".lmb_data")))
+#define FAST_RODATA __attribute__((section(".lmb_rodata")))
+#else
+#define FAST_CODE
+#define FAST_DATA
+#define FAST_RODATA
+#endif
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+
+// Print LMB section usage (from the linker symbols in lscript.ld) over UART
+void mem_placement_report(void);
+
+#endif // MEM_PLACEMENT_H
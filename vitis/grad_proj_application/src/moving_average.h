@@ -0,0 +1,61 @@
+#ifndef MOVING_AVERAGE_H
+#define MOVING_AVERAGE_H
+
+#include <stdint.h>
+#include "xil_types.h"
+#include "mem_placement.h"
+
+// ============================================================================
+// RUNNING-SUM MOVING AVERAGE
+// ============================================================================
+// Boxcar average over the last 'length' samples (length = 1, 2, 4, 8 or 16).
+// A push subtracts the sample leaving the window from the running sum and adds
+// the new one, so the cost is O(1) whatever the length, and the divide is a shift.
+//
+// Also usable as a decimator: push every sample and keep the result only when
+// moving_average_wrapped() is true (once per 'length' samples), which gives
+// non-overlapping averages at 1/length of the input rate.
+//
+// The sum is 32 bits, so |sample| must stay below 2^31 / length.
+
+#define MOVING_AVERAGE_MAX_LENGTH 16
+
+typedef struct {
+	int32_t window[MOVING_AVERAGE_MAX_LENGTH];
+	int32_t sum;
+	u32 index;      // slot the next sample goes into
+	u32 mask;       // length - 1
+	u32 shift;      // log2(length)
+} moving_average_t;
+
+// Fill the window with 'initial' (so the first averages aren't pulled toward 0)
+// length must be a power of 2, at most MOVING_AVERAGE_MAX_LENGTH
+static inline void moving_average_init(moving_average_t* average, u32 length, int32_t initial) {
+	average->shift = 0;
+	while ((1u << average->shift) < length) {
+		average->shift++;
+	}
+	average->mask = length - 1;
+	average->index = 0;
+	for (u32 i = 0; i < length; i++) {
+		average->window[i] = initial;
+	}
+	average->sum = initial * (int32_t) length;
+}
+
+// Add one sample
+// Returns: average of the last 'length' samples (rounded toward -infinity)
+static inline FAST_CODE int32_t moving_average_push(moving_average_t* average, int32_t sample) {
+	u32 index = average->index;
+	average->sum += sample - average->window[index];
+	average->window[index] = sample;
+	average->index = (index + 1) & average->mask;
+	return average->sum >> average->shift;
+}
+
+// Returns: 1 if the last push completed a full window (decimation point), 0 otherwise
+static inline FAST_CODE int moving_average_wrapped(const moving_average_t* average) {
+	return average->index == 0;
+}
+
+#endif // MOVING_AVERAGE_H
@@ -0,0 +1,112 @@
+#include "param_smooth.h"
+#include "audio_chain.h"
+#include "delay.h"
+#include "tremolo.h"
+#include "chorus.h"
+
+// ============================================================================
+// PARAMETER SMOOTHING STATE VARIABLES
+// ============================================================================
+// Only touched from the audio context (sampling_ISR, or the main loop in block mode)
+
+param_smooth_t smoothed_params[SMOOTH_PARAM_COUNT] FAST_DATA = {
+	[SMOOTH_DELAY_SAMPLES] = { .mode = PARAM_SMOOTH_LINEAR },   // constant pitch bend while it glides
+	[SMOOTH_CHORUS_DELAY]  = { .mode = PARAM_SMOOTH_LINEAR },
+	[SMOOTH_CHORUS_DEPTH]  = { .mode = PARAM_SMOOTH_ONE_POLE },
+	[SMOOTH_FLANGER_DELAY] = { .mode = PARAM_SMOOTH_LINEAR },
+	[SMOOTH_FLANGER_DEPTH] = { .mode = PARAM_SMOOTH_ONE_POLE },
+	[SMOOTH_VIBRATO_DEPTH] = { .mode = PARAM_SMOOTH_LINEAR },
+	[SMOOTH_TREMOLO_DEPTH] = { .mode = PARAM_SMOOTH_ONE_POLE },
+	[SMOOTH_LP_COEFF]      = { .mode = PARAM_SMOOTH_ONE_POLE },
+	[SMOOTH_HP_COEFF]      = { .mode = PARAM_SMOOTH_ONE_POLE },
+};
+
+// ============================================================================
+// TARGETS
+// ============================================================================
+static inline FAST_CODE u32 read_target(smooth_param_t param) {
+	switch (param) {
+	case SMOOTH_DELAY_SAMPLES: return delay_samples;
+	case SMOOTH_CHORUS_DELAY:  return chorus_delay;
+	case SMOOTH_CHORUS_DEPTH:  return chorus_depth;
+	case SMOOTH_FLANGER_DELAY: return flanger_delay;
+	case SMOOTH_FLANGER_DEPTH: return flanger_depth;
+	case SMOOTH_VIBRATO_DEPTH: return vibrato_depth;
+	case SMOOTH_TREMOLO_DEPTH: return tremolo_depth;
+	case SMOOTH_LP_COEFF:      return lp_filter_coeff;
+	case SMOOTH_HP_COEFF:      return hp_filter_coeff;
+	default:                   return 0;
+	}
+}
+
+// ============================================================================
+// RAMPS
+// ============================================================================
+static inline FAST_CODE void smooth_jump(param_smooth_t* smooth, u32 target) {
+	smooth->target = target;
+	smooth->value = (int32_t) (target << PARAM_SMOOTH_FRAC_BITS);
+	smooth->ticks_left = 0;
+	smooth->primed = 1;
+}
+
+static inline FAST_CODE void smooth_advance(param_smooth_t* smooth, u32 target) {
+	int32_t target_q8 = (int32_t) (target << PARAM_SMOOTH_FRAC_BITS);
+
+	if (smooth->mode == PARAM_SMOOTH_LINEAR) {
+		// a new target restarts the ramp from wherever the value is now
+		if (target != smooth->target) {
+			smooth->target = target;
+			smooth->step = (target_q8 - smooth->value) / PARAM_SMOOTH_RAMP_TICKS;
+			smooth->ticks_left = PARAM_SMOOTH_RAMP_TICKS;
+		}
+		if (smooth->ticks_left > 1) {
+			smooth->value += smooth->step;
+			smooth->ticks_left--;
+		}
+		else {
+			// last step lands exactly on the target (the division may have rounded)
+			smooth->value = target_q8;
+			smooth->ticks_left = 0;
+		}
+	}
+	else {
+		smooth->target = target;
+		int32_t delta = (target_q8 - smooth->value) >> PARAM_SMOOTH_POLE_SHIFT;
+		if (delta == 0) {
+			// the last few Q8 steps would never close with the shift; finish the ramp
+			smooth->value = target_q8;
+		}
+		else {
+			smooth->value += delta;
+		}
+	}
+}
+
+FAST_CODE void param_smooth_tick(void) {
+	for (u32 i = 0; i < SMOOTH_PARAM_COUNT; i++) {
+		param_smooth_t* smooth = &smoothed_params[i];
+		u32 target = read_target((smooth_param_t) i);
+#if PARAM_SMOOTHING
+		if (smooth->primed) {
+			smooth_advance(smooth, target);
+			continue;
+		}
+#endif
+		smooth_jump(smooth, target);
+	}
+}
+
+void param_smooth_snap(void) {
+	for (u32 i = 0; i < SMOOTH_PARAM_COUNT; i++) {
+		smooth_jump(&smoothed_params[i], read_target((smooth_param_t) i));
+	}
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+void init_param_smooth(void) {
+	for (u32 i = 0; i < SMOOTH_PARAM_COUNT; i++) {
+		smoothed_params[i].primed = 0;
+	}
+}
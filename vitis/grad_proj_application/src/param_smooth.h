@@ -0,0 +1,88 @@
+#ifndef PARAM_SMOOTH_H
+#define PARAM_SMOOTH_H
+
+#include <stdint.h>
+#include "xil_types.h"
+#include "mem_placement.h"
+
+// ============================================================================
+// PARAMETER SMOOTHING CONFIGURATION
+// ============================================================================
+// enc_ISR() and pushBtn_ISR() change parameters in big steps (1000 samples of
+// delay, 10 samples of chorus depth, ...). Read directly, every step is a jump
+// in the signal and clicks. The effects read the smoothed copies kept here
+// instead, which follow the volatile targets with a one-pole or linear ramp.
+//
+// The ramps advance in ticks, not per sample: once per block in block mode, and
+// once every PARAM_SMOOTH_INTERVAL samples in per-sample mode, so the cost is a
+// few instructions per parameter per tick. Values are Q8 (8 fraction bits), so
+// a delay can glide by less than a sample per tick.
+
+#ifndef PARAM_SMOOTHING
+#define PARAM_SMOOTHING 1 // 0 = smoothed values jump straight to the target on every tick
+#endif
+
+// Per-sample mode: samples per tick (block mode ticks once per audio_process_block())
+#define PARAM_SMOOTH_INTERVAL    32 // 1.5 kHz at 48.8 kHz
+
+#define PARAM_SMOOTH_FRAC_BITS   8
+
+// One-pole: each tick closes 1/2^PARAM_SMOOTH_POLE_SHIFT of the remaining gap
+#define PARAM_SMOOTH_POLE_SHIFT  3  // time constant ~8 ticks (~5 ms)
+
+// Linear: a new target is reached in PARAM_SMOOTH_RAMP_TICKS equal steps
+#define PARAM_SMOOTH_RAMP_TICKS  32 // ~21 ms
+
+#define PARAM_SMOOTH_ONE_POLE    0
+#define PARAM_SMOOTH_LINEAR      1
+
+typedef struct {
+	int32_t value;      // current value (Q8)
+	int32_t step;       // linear: increment per tick (Q8)
+	u32 target;         // target the ramp is heading to
+	u32 ticks_left;     // linear: ticks until target is reached
+	u8 mode;            // PARAM_SMOOTH_ONE_POLE or PARAM_SMOOTH_LINEAR
+	u8 primed;          // 0 = jump to the target on the next tick
+} param_smooth_t;
+
+// Smoothed parameters of the audio chain
+typedef enum {
+	SMOOTH_DELAY_SAMPLES = 0,   // used with DELAY_TIME_SMOOTHING = DELAY_SMOOTH_GLIDE and by the tape delay
+	SMOOTH_CHORUS_DELAY,
+	SMOOTH_CHORUS_DEPTH,
+	SMOOTH_FLANGER_DELAY,
+	SMOOTH_FLANGER_DEPTH,
+	SMOOTH_VIBRATO_DEPTH,       // also moves the vibrato's base delay, so it ramps linearly
+	SMOOTH_TREMOLO_DEPTH,
+	SMOOTH_LP_COEFF,
+	SMOOTH_HP_COEFF,
+	SMOOTH_PARAM_COUNT
+} smooth_param_t;
+
+extern param_smooth_t smoothed_params[SMOOTH_PARAM_COUNT];
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+
+// Current smoothed value, whole units
+static inline FAST_CODE u32 smoothed_value(smooth_param_t param) {
+	return (u32) (smoothed_params[param].value >> PARAM_SMOOTH_FRAC_BITS);
+}
+
+// Current smoothed value, Q8
+static inline FAST_CODE u32 smoothed_value_q8(smooth_param_t param) {
+	return (u32) smoothed_params[param].value;
+}
+
+// Read every target and advance every ramp by one tick
+void param_smooth_tick(void);
+
+// Jump every smoothed value to its target now (for callers that set a parameter
+// and run an effect directly, without the chain ticking)
+void param_smooth_snap(void);
+
+// Forget the ramps; the next tick jumps to the targets
+void init_param_smooth(void);
+
+#endif // PARAM_SMOOTH_H
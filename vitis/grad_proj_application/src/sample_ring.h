@@ -0,0 +1,56 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stdint.h>
+#include "xil_types.h"
+#include "mem_placement.h"
+
+// ============================================================================
+// LOCK-FREE SAMPLE RING (single producer / single consumer)
+// ============================================================================
+// One side (e.g. sampling_ISR) only ever moves 'head', the other side (e.g. the
+// main loop) only ever moves 'tail', so no locking or interrupt masking is needed.
+// head and tail are free-running counters; the difference is the fill level and
+// the storage index is (counter & mask). Size must be a power of 2.
+
+typedef struct {
+	volatile int32_t* data;
+	u32 mask;               // size - 1
+	volatile u32 head;      // total samples pushed (producer owned)
+	volatile u32 tail;      // total samples popped (consumer owned)
+} sample_ring_t;
+
+static inline void sample_ring_init(sample_ring_t* ring, volatile int32_t* storage, u32 size) {
+	ring->data = storage;
+	ring->mask = size - 1;
+	ring->head = 0;
+	ring->tail = 0;
+}
+
+static inline FAST_CODE u32 sample_ring_count(const sample_ring_t* ring) {
+	return ring->head - ring->tail;
+}
+
+// Returns: 1 if the sample was queued, 0 if the ring is full
+static inline FAST_CODE int sample_ring_push(sample_ring_t* ring, int32_t sample) {
+	u32 head = ring->head;
+	if ((head - ring->tail) > ring->mask) {
+		return 0;
+	}
+	ring->data[head & ring->mask] = sample;
+	ring->head = head + 1; // publish only after the data is stored
+	return 1;
+}
+
+// Returns: 1 if a sample was popped into *sample, 0 if the ring is empty
+static inline FAST_CODE int sample_ring_pop(sample_ring_t* ring, int32_t* sample) {
+	u32 tail = ring->tail;
+	if (tail == ring->head) {
+		return 0;
+	}
+	*sample = ring->data[tail & ring->mask];
+	ring->tail = tail + 1;
+	return 1;
+}
+
+#endif // SAMPLE_RING_H
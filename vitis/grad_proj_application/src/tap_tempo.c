@@ -0,0 +1,123 @@
+#include "tap_tempo.h"
+#include "delay.h"
+#include "console.h"
+
+// ============================================================================
+// TAP TEMPO STATE VARIABLES
+// ============================================================================
+
+const tap_subdivision_info_t tap_subdivisions[TAP_SUBDIVISION_COUNT] = {
+	{ "quarter",       1, 1 },
+	{ "dotted eighth", 3, 4 },
+	{ "eighth",        1, 2 },
+	{ "triplet",       1, 3 },
+	{ "sixteenth",     1, 4 },
+};
+
+volatile u8 tap_subdivision = TAP_SUBDIVISION_QUARTER;
+
+// ISR -> main loop queue, same single-producer scheme as event_log.h
+static u32 tap_queue[TAP_TEMPO_QUEUE_SIZE];
+static volatile u32 tap_queue_head = 0;     // producer (pushBtn_ISR) owned
+static volatile u32 tap_queue_tail = 0;     // consumer (main loop) owned
+
+// Main loop only
+static u32 tap_times[TAP_TEMPO_TAPS];       // oldest first
+static u32 tap_count = 0;
+static u32 beat_samples = 0;                // 0 until two taps have been seen
+static u32 applied_subdivision = TAP_SUBDIVISION_QUARTER;
+
+// ============================================================================
+// ISR SIDE
+// ============================================================================
+void tap_tempo_tap(u32 timestamp) {
+	u32 head = tap_queue_head;
+	if ((head - tap_queue_tail) >= TAP_TEMPO_QUEUE_SIZE) {
+		return;
+	}
+	tap_queue[head & (TAP_TEMPO_QUEUE_SIZE - 1)] = timestamp;
+	tap_queue_head = head + 1; // publish only after the timestamp is stored
+}
+
+// ============================================================================
+// TEMPO ESTIMATE
+// ============================================================================
+static void add_tap(u32 timestamp) {
+	if (tap_count > 0) {
+		u32 interval = timestamp - tap_times[tap_count - 1];
+		if (interval > TAP_TEMPO_TIMEOUT) {
+			// too long since the last tap: this one starts a new tempo
+			tap_count = 0;
+		}
+		else if (beat_samples) {
+			u32 error = (interval > beat_samples) ? interval - beat_samples : beat_samples - interval;
+			if (error > (beat_samples >> TAP_TEMPO_TOLERANCE_SHIFT)) {
+				// tempo change: average from the previous tap on
+				tap_times[0] = tap_times[tap_count - 1];
+				tap_count = 1;
+			}
+		}
+	}
+
+	if (tap_count == TAP_TEMPO_TAPS) {
+		for (u32 i = 1; i < TAP_TEMPO_TAPS; i++) {
+			tap_times[i - 1] = tap_times[i];
+		}
+		tap_count--;
+	}
+	tap_times[tap_count++] = timestamp;
+
+	// mean interval = span of the kept taps / number of intervals
+	// (a single tap keeps the previous beat, so the subdivision can still be changed)
+	if (tap_count >= 2) {
+		beat_samples = (tap_times[tap_count - 1] - tap_times[0]) / (tap_count - 1);
+	}
+}
+
+static void apply_beat(u32 subdivision) {
+	const tap_subdivision_info_t* info = &tap_subdivisions[subdivision];
+	u32 delay = (beat_samples * info->numerator) / info->denominator;
+	if (delay < DELAY_SAMPLES_MIN) delay = DELAY_SAMPLES_MIN;
+	if (delay > DELAY_SAMPLES_MAX) delay = DELAY_SAMPLES_MAX;
+	delay_samples = delay;
+
+	console_printf("Tap tempo: %lu BPM (beat %lu samples), %s -> delay %lu samples\r\n",
+			   (60 * TAP_TEMPO_SAMPLE_RATE + beat_samples / 2) / beat_samples, beat_samples, info->name, delay);
+}
+
+// ============================================================================
+// MAIN LOOP SIDE
+// ============================================================================
+void tap_tempo_service(void) {
+	u32 changed = 0;
+
+	while (tap_queue_tail != tap_queue_head) {
+		u32 tail = tap_queue_tail;
+		u32 beat_before = beat_samples;
+		add_tap(tap_queue[tail & (TAP_TEMPO_QUEUE_SIZE - 1)]);
+		tap_queue_tail = tail + 1;
+		changed |= (beat_samples != beat_before);
+	}
+
+	u32 subdivision = tap_subdivision;
+	if (subdivision >= TAP_SUBDIVISION_COUNT) subdivision = TAP_SUBDIVISION_QUARTER;
+	if (subdivision != applied_subdivision) {
+		applied_subdivision = subdivision;
+		changed = 1;
+	}
+
+	if (changed && beat_samples) {
+		apply_beat(subdivision);
+	}
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+void init_tap_tempo(void) {
+	tap_queue_tail = tap_queue_head;
+	tap_count = 0;
+	beat_samples = 0;
+	tap_subdivision = TAP_SUBDIVISION_QUARTER;
+	applied_subdivision = TAP_SUBDIVISION_QUARTER;
+}
@@ -0,0 +1,65 @@
+#ifndef TAP_TEMPO_H
+#define TAP_TEMPO_H
+
+#include <stdint.h>
+#include "xil_types.h"
+
+// ============================================================================
+// TAP TEMPO CONFIGURATION
+// ============================================================================
+// While the delay is on, BTN_TAP_TEMPO (bsp.h) is a tap button. pushBtn_ISR()
+// only queues the sys_tick_counter timestamp of each tap (in samples); the
+// main loop runs tap_tempo_service(), which averages the last few intervals
+// into a beat length, scales it by the selected subdivision and writes the
+// result to delay_samples. From there it is a normal delay change, so it is
+// smoothed like an encoder turn (DELAY_TIME_SMOOTHING in delay.h).
+
+#define TAP_TEMPO_SAMPLE_RATE   48828 // match system sample rate
+
+#define TAP_TEMPO_TAPS          5     // timestamps kept: the beat is the mean of the last 4 intervals
+#define TAP_TEMPO_TIMEOUT       (2 * TAP_TEMPO_SAMPLE_RATE) // a longer gap starts a new tempo (30 BPM)
+#define TAP_TEMPO_QUEUE_SIZE    8     // taps waiting for the main loop (must be power of 2)
+
+// An interval that differs from the running beat by more than 1/2^TAP_TEMPO_TOLERANCE_SHIFT
+// of it is taken as a tempo change: the averaging restarts from the previous tap
+#define TAP_TEMPO_TOLERANCE_SHIFT 2   // 25%
+
+// Subdivisions of the tapped beat
+typedef enum {
+	TAP_SUBDIVISION_QUARTER = 0,        // delay = beat
+	TAP_SUBDIVISION_DOTTED_EIGHTH,      // 3/4 beat
+	TAP_SUBDIVISION_EIGHTH,             // 1/2 beat
+	TAP_SUBDIVISION_TRIPLET,            // 1/3 beat
+	TAP_SUBDIVISION_SIXTEENTH,          // 1/4 beat
+	TAP_SUBDIVISION_COUNT
+} tap_subdivision_t;
+
+typedef struct {
+	const char* name;
+	u32 numerator;
+	u32 denominator;
+} tap_subdivision_info_t;
+
+extern const tap_subdivision_info_t tap_subdivisions[TAP_SUBDIVISION_COUNT];
+
+// ============================================================================
+// TAP TEMPO STATE VARIABLES (extern for access from bsp.c)
+// ============================================================================
+
+extern volatile u8 tap_subdivision;     // tap_subdivision_t, selected with the encoder
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+
+// ISR side: queue one tap (never blocks; a full queue drops the tap)
+void tap_tempo_tap(u32 timestamp);
+
+// Main loop side: fold queued taps into the beat and apply it to delay_samples
+// (also re-applies the beat after a subdivision change)
+void tap_tempo_service(void);
+
+// Forget the taps and the beat
+void init_tap_tempo(void);
+
+#endif // TAP_TEMPO_H
@@ -18,20 +18,16 @@
 #define TREMOLO_DEPTH_MAX         256   // 100% depth
 #define TREMOLO_DEPTH_DEFAULT     256   // 100% depth default
 
-// Sample rate (Hz)
-#define TREMOLO_SAMPLE_RATE       48828 // switch back to 48000 if something breaks
-
-// Sine table size (must be power of 2 for efficient wrapping)
-#define TREMOLO_SINE_TABLE_SIZE   256
+// The LFO is LFO_TREMOLO in the shared bank (lfo.h)
 
 // ============================================================================
 // TREMOLO STATE VARIABLES (extern for access from bsp.c)
 // ============================================================================
-extern const uint8_t sine_table[TREMOLO_SINE_TABLE_SIZE];
 extern volatile u8 tremolo_enabled;      // Effect enable flag
 extern volatile u32 tremolo_rate;        // LFO rate (in 0.1 Hz units)
 extern volatile u32 tremolo_depth;       // Modulation depth
-extern volatile u8 tremolo_adjust_mode;
+extern volatile u8 tremolo_waveform;     // lfo_waveform_t (lfo.h)
+extern volatile u8 tremolo_adjust_mode;  // 0 = rate, 1 = depth, 2 = waveform
 
 // ============================================================================
 // FUNCTION PROTOTYPES
@@ -41,10 +37,16 @@ extern volatile u8 tremolo_adjust_mode;
 // Returns: modulated audio sample
 int32_t process_tremolo(int32_t input);
 
-// Update phase increment when tremolo rate changes
+// Process a block of samples through tremolo effect, in place
+void process_tremolo_block(int32_t* samples, u32 count);
+
+// Update the LFO_TREMOLO phase increment when tremolo rate changes
 // Call this whenever tremolo_rate is modified
 void update_tremolo_phase_inc(void);
 
+// Apply tremolo_waveform to LFO_TREMOLO
+void update_tremolo_waveform(void);
+
 // Initialize tremolo effect
 void init_tremolo(void);
 